@@ -0,0 +1,94 @@
+#pragma once
+
+// Link tuning for the ESP32 Arduino BLE server. Web Bluetooth pages cannot
+// ask for MTU, PHY or connection interval, so the peripheral does it: it
+// advertises the largest local MTU, and on every connection asks for 2M PHY
+// (BLE 5 chips only) and the shortest interval the central will accept.
+// An idle board (idle_mode.h) asks for a slow interval with peripheral
+// latency instead and goes back to the fast one on wake-up.
+//
+//   setup():                  configureLinkDefaults();
+//   onConnect(server, param): requestFastLink(param->connect.remote_bda);
+//   idle / wake:              requestIdleLink(peer) / requestFastLink(peer)
+//   after MTU exchange:       streamer.setBatchLimit(chunkSamplesForMtu(
+//                                 server->getPeerMTU(connId), kFrameHeaderSize, sampleBytes(flags)))
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace pressurepad {
+
+constexpr uint16_t kPreferredMtu = 517;
+constexpr uint16_t kAttHeaderBytes = 3;
+
+// Largest value one notification can carry on a link with this ATT MTU.
+inline size_t notifyPayloadLimit(uint16_t mtu) {
+    return mtu > kAttHeaderBytes ? mtu - kAttHeaderBytes : 0;
+}
+
+// Samples per stream chunk that fit in one notification for the given
+// per-sample worst case (see sampleBytes()).
+inline size_t chunkSamplesForMtu(uint16_t mtu, size_t headerBytes, size_t bytesPerSample) {
+    size_t payload = notifyPayloadLimit(mtu);
+    return payload > headerBytes ? (payload - headerBytes) / bytesPerSample : 0;
+}
+
+}  // namespace pressurepad
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <BLEDevice.h>
+#include <esp_gap_ble_api.h>
+
+namespace pressurepad {
+
+// Connection interval in 1.25 ms units: 7.5-15 ms, no slave latency,
+// 4 s supervision timeout.
+constexpr uint16_t kMinConnInterval = 6;
+constexpr uint16_t kMaxConnInterval = 12;
+constexpr uint16_t kSupervisionTimeout = 400;
+
+// Idle: 100-125 ms, and the board may skip 4 events in a row when it has
+// nothing to send. A notification still goes out at the next event, so a
+// wake-up reaches the page within one interval.
+constexpr uint16_t kIdleMinConnInterval = 80;
+constexpr uint16_t kIdleMaxConnInterval = 100;
+constexpr uint16_t kIdleLatency = 4;
+// Must exceed (1 + latency) * interval * 2; 6 s.
+constexpr uint16_t kIdleSupervisionTimeout = 600;
+
+inline void configureLinkDefaults() {
+    BLEDevice::setMTU(kPreferredMtu);
+}
+
+inline void requestFastLink(const esp_bd_addr_t remote) {
+    esp_ble_conn_update_params_t params = {};
+    memcpy(params.bda, remote, sizeof(esp_bd_addr_t));
+    params.min_int = kMinConnInterval;
+    params.max_int = kMaxConnInterval;
+    params.latency = 0;
+    params.timeout = kSupervisionTimeout;
+    esp_ble_gap_update_conn_params(&params);
+
+#if defined(SOC_BLE_50_SUPPORTED) && SOC_BLE_50_SUPPORTED
+    esp_bd_addr_t addr;
+    memcpy(addr, remote, sizeof(esp_bd_addr_t));
+    esp_ble_gap_set_preferred_phy(addr, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                  ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#endif
+}
+
+inline void requestIdleLink(const esp_bd_addr_t remote) {
+    esp_ble_conn_update_params_t params = {};
+    memcpy(params.bda, remote, sizeof(esp_bd_addr_t));
+    params.min_int = kIdleMinConnInterval;
+    params.max_int = kIdleMaxConnInterval;
+    params.latency = kIdleLatency;
+    params.timeout = kIdleSupervisionTimeout;
+    esp_ble_gap_update_conn_params(&params);
+}
+
+}  // namespace pressurepad
+
+#endif  // ARDUINO_ARCH_ESP32
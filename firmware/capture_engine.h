@@ -0,0 +1,93 @@
+#pragma once
+
+// Board capture engine. sample() runs at the capture rate from the timer
+// driven sampling context and only reads the load cells and pushes into the
+// SPSC ring; the BLE task calls drain() whenever it gets to run, so BLE
+// stack latency never shifts when a sample is taken.
+//
+// Source must provide `void read(int32_t& leadGrams, int32_t& trailGrams)`;
+// CalibratedSource (load_cell_calibration.h) turns raw load-cell counts into
+// such a source. A source that fills in more than the two weights, such as
+// CenterOfPressureSource (pressure_center.h), provides `void
+// read(SwingSample&)` instead and gets the sample with tUs already set.
+
+#include <stdint.h>
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+#include "spsc_ring.h"
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+template <typename Source, typename = void>
+struct ReadsWholeSample : std::false_type {};
+
+template <typename Source>
+struct ReadsWholeSample<Source, std::void_t<decltype(std::declval<Source&>().read(std::declval<SwingSample&>()))>>
+    : std::true_type {};
+
+template <typename Source, size_t RingCapacity = 1024>
+class CaptureEngine {
+public:
+    explicit CaptureEngine(Source& source) : source_(source) {}
+
+    void start(uint32_t nowUs) {
+        startUs_ = nowUs;
+        running_.store(true, std::memory_order_release);
+    }
+
+    void stop() { running_.store(false, std::memory_order_release); }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // Sampling context: one call per timer tick.
+    void sample(uint32_t nowUs) {
+        if (!running_.load(std::memory_order_acquire)) return;
+        SwingSample s;
+        s.tUs = nowUs - startUs_;
+        if constexpr (ReadsWholeSample<Source>::value) {
+            source_.read(s);
+        } else {
+            source_.read(s.leadGrams, s.trailGrams);
+        }
+        if (!ring_.push(s)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const size_t depth = ring_.size();
+        if (depth > highWater_.load(std::memory_order_relaxed)) highWater_.store(depth, std::memory_order_relaxed);
+    }
+
+    // BLE task: hands every queued sample to `sink(const SwingSample&)` and
+    // returns how many were drained.
+    template <typename Sink>
+    size_t drain(Sink&& sink) {
+        size_t n = 0;
+        SwingSample s;
+        while (ring_.pop(s)) {
+            sink(s);
+            n++;
+        }
+        return n;
+    }
+
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    size_t queued() const { return ring_.size(); }
+    // Deepest the ring has been since boot; near ringCapacity() means the
+    // BLE task is falling behind (see diagnostics.h).
+    size_t highWater() const { return highWater_.load(std::memory_order_relaxed); }
+    static constexpr size_t ringCapacity() { return RingCapacity; }
+
+private:
+    Source& source_;
+    SpscRing<SwingSample, RingCapacity> ring_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<size_t> highWater_{0};
+    uint32_t startUs_ = 0;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,84 @@
+#pragma once
+
+// ESP32 binding for CaptureEngine. A hardware timer ISR stamps the tick and
+// wakes a sampling task pinned to core 1, away from the BLE controller on
+// core 0. The load-cell read happens in that task because the oneshot ADC
+// driver is not ISR safe; task notification keeps wake-up to a few
+// microseconds, so 200-500 Hz capture does not jitter with BLE traffic.
+// With a SampleTiming (diagnostics.h) each sample's read time and wake-up
+// latency are recorded as well.
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include "capture_engine.h"
+#include "diagnostics.h"
+
+namespace pressurepad {
+
+template <typename Engine>
+class Esp32Sampler {
+public:
+    explicit Esp32Sampler(Engine& engine, SampleTiming* timing = nullptr) : engine_(engine), timing_(timing) {}
+
+    bool begin(uint32_t rateHz) {
+        instance_ = this;
+        if (xTaskCreatePinnedToCore(taskEntry, "sampler", 4096, this, configMAX_PRIORITIES - 1, &task_, 1) != pdPASS) {
+            return false;
+        }
+        timer_ = timerBegin(1000000);
+        if (!timer_) return false;
+        timerAttachInterrupt(timer_, onTimer);
+        setRate(rateHz);
+        return true;
+    }
+
+    void setRate(uint32_t rateHz) {
+        if (rateHz == 0) return;
+        timerAlarm(timer_, 1000000 / rateHz, true, 0);
+    }
+
+    // Timer ticks that fired while the previous sample was still being read.
+    uint32_t missedTicks() const { return missed_; }
+
+private:
+    static void ARDUINO_ISR_ATTR onTimer() {
+        instance_->tickUs_ = static_cast<uint32_t>(esp_timer_get_time());
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(instance_->task_, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+
+    static void taskEntry(void* arg) {
+        auto* self = static_cast<Esp32Sampler*>(arg);
+        for (;;) {
+            uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (ticks > 1) self->missed_ += ticks - 1;
+            const uint32_t tickUs = self->tickUs_;
+            if (!self->timing_) {
+                self->engine_.sample(tickUs);
+                continue;
+            }
+            const uint32_t startUs = static_cast<uint32_t>(esp_timer_get_time());
+            self->engine_.sample(tickUs);
+            self->timing_->record(static_cast<uint32_t>(esp_timer_get_time()) - startUs, startUs - tickUs);
+        }
+    }
+
+    Engine& engine_;
+    SampleTiming* timing_;
+    hw_timer_t* timer_ = nullptr;
+    TaskHandle_t task_ = nullptr;
+    volatile uint32_t tickUs_ = 0;
+    uint32_t missed_ = 0;
+    static Esp32Sampler* instance_;
+};
+
+template <typename Engine>
+Esp32Sampler<Engine>* Esp32Sampler<Engine>::instance_ = nullptr;
+
+}  // namespace pressurepad
+
+#endif  // ARDUINO_ARCH_ESP32
@@ -0,0 +1,166 @@
+#pragma once
+
+// Continuous capture history with pre-roll and post-roll. Every drained
+// sample goes into a fixed ring that is never cleared, so at START_SWING
+// the last preRollMs of stance are already in memory. The swing window
+// runs from preRollMs before START_SWING to postRollMs after IMPACT_BEEP
+// and is read in place: no samples are copied out of the ring, the stream
+// chunks and the kMsgSwing frame are encoded straight from it.
+//
+// Window times are relative to the first sample in the window, so Start
+// lands at preRollMs on the page's axis (advertised in the config message).
+// Event times and SwingMetrics marks must use the same origin:
+//
+//   CaptureWindow<4096> window;                       // 64 KB, fixed
+//   window.configure(deviceConfig);                   // after RATE:/ROLL:
+//   engine.drain([&](const SwingSample& s) { window.push(s); });
+//   START_SWING:  window.markStart(nowUs); streamer.begin(0);
+//                 metrics.begin(0, window.relativeUs(nowUs));
+//   TOP_BEEP:     metrics.markTop(window.relativeUs(nowUs));
+//   IMPACT_BEEP:  window.markImpact(nowUs); metrics.markImpact(window.relativeUs(nowUs));
+//   every loop:   window.streamPending([&](const SwingSample& s) { streamer.push(s, send); metrics.add(s); });
+//                 if (window.ready()) { streamer.end(send); window.release(); }
+// Capture times (`nowUs`) are on the engine's clock, like the raw samples.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "device_config.h"
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+template <size_t Capacity>
+class CaptureWindow {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t kBytes = Capacity * sizeof(SwingSample);
+
+    enum class State : uint8_t { Idle, Open, Closing, Ready };
+
+    // Clamps the pre- and post-roll so that, at the current sample period,
+    // both rolls plus `swingMs` between start and impact fit in the ring,
+    // and writes the effective values back for the config message.
+    void configure(DeviceConfig& cfg, uint32_t swingMs = 2000) {
+        const uint32_t periodUs = cfg.samplePeriodUs() ? cfg.samplePeriodUs() : 1;
+        const uint32_t capacityMs = static_cast<uint32_t>(static_cast<uint64_t>(Capacity) * periodUs / 1000);
+        const uint32_t budgetMs = capacityMs > swingMs ? capacityMs - swingMs : 0;
+        uint32_t pre = cfg.preRollMs;
+        uint32_t post = cfg.postRollMs;
+        if (pre + post > budgetMs) {
+            // Shrink both in proportion so a long pre-roll keeps its share.
+            const uint32_t total = pre + post;
+            pre = static_cast<uint32_t>(static_cast<uint64_t>(pre) * budgetMs / total);
+            post = budgetMs - pre;
+        }
+        cfg.preRollMs = static_cast<uint16_t>(pre);
+        cfg.postRollMs = static_cast<uint16_t>(post);
+        preRollUs_ = pre * 1000;
+        postRollUs_ = post * 1000;
+    }
+
+    // BLE task: every sample drained from the capture engine, oldest first.
+    void push(const SwingSample& s) {
+        slots_[written_ & kMask] = s;
+        written_++;
+        if (state_ == State::Idle) return;
+        // A window longer than the ring loses its oldest samples, never the
+        // live end of the swing.
+        if (written_ - origin_ > Capacity) {
+            origin_ = written_ - Capacity;
+            if (state_ == State::Ready && origin_ > end_) origin_ = end_;
+            if (streamed_ < origin_) streamed_ = origin_;
+            truncated_ = true;
+        }
+        if (state_ == State::Closing && static_cast<int32_t>(s.tUs - endUs_) >= 0) {
+            end_ = written_;
+            state_ = State::Ready;
+        }
+    }
+
+    // Opens the window at the oldest sample within preRollMs of `startUs`.
+    // Samples still queued in the engine are newer and arrive via push().
+    void markStart(uint32_t startUs) {
+        const uint32_t fromUs = startUs - preRollUs_;
+        size_t origin = written_;
+        while (origin > 0 && written_ - origin < Capacity &&
+               static_cast<int32_t>(slots_[(origin - 1) & kMask].tUs - fromUs) >= 0) {
+            origin--;
+        }
+        origin_ = origin;
+        streamed_ = origin;
+        end_ = 0;
+        truncated_ = false;
+        originUs_ = origin < written_ ? slots_[origin & kMask].tUs : fromUs;
+        state_ = State::Open;
+    }
+
+    void markImpact(uint32_t impactUs) {
+        if (state_ != State::Open) return;
+        endUs_ = impactUs + postRollUs_;
+        state_ = State::Closing;
+    }
+
+    bool ready() const { return state_ == State::Ready; }
+    State state() const { return state_; }
+    bool truncated() const { return truncated_; }
+    void release() { state_ = State::Idle; }
+
+    // Window time of a capture-clock instant.
+    uint32_t relativeUs(uint32_t captureUs) const { return captureUs - originUs_; }
+
+    // Samples in the window so far (all of it once ready()).
+    size_t size() const {
+        if (state_ == State::Idle) return 0;
+        return (state_ == State::Ready ? end_ : written_) - origin_;
+    }
+
+    // Sample `i` of the window with its time on the window's axis.
+    SwingSample at(size_t i) const {
+        SwingSample s = slots_[(origin_ + i) & kMask];
+        s.tUs -= originUs_;
+        return s;
+    }
+
+    // Hands every window sample not yet handed out to `sink(const
+    // SwingSample&)`, with window-relative times, and returns the count.
+    // The first call after markStart() delivers the whole pre-roll.
+    template <typename Sink>
+    size_t streamPending(Sink&& sink) {
+        if (state_ == State::Idle) return 0;
+        const size_t stop = state_ == State::Ready ? end_ : written_;
+        size_t n = 0;
+        for (; streamed_ < stop; streamed_++, n++) sink(at(streamed_ - origin_));
+        return n;
+    }
+
+    // Encodes the finished window as one kMsgSwing frame, reading the ring
+    // in place. Returns 0 if it does not fit (see encodeSwingFrame() and
+    // writeFrameSamplesAt()).
+    size_t encode(uint8_t* out, size_t cap, const FrameConfig& cfg) const {
+        const size_t count = size();
+        if (count == 0 || count > UINT16_MAX || cfg.tickUs == 0 || cfg.gramsPerLsb == 0) return 0;
+        if (swingFrameSize(count, cfg.flags) > cap) return 0;
+        writeFrameHeader(out, kMsgSwing, cfg.flags, static_cast<uint16_t>(count), cfg, 0);
+        return writeFrameSamplesAt(out, count, cfg, originUs_,
+                                   [this](size_t i) -> const SwingSample& { return slots_[(origin_ + i) & kMask]; });
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    SwingSample slots_[Capacity];
+    size_t written_ = 0;   // samples ever pushed; slot = index & kMask
+    size_t origin_ = 0;    // first sample of the window
+    size_t streamed_ = 0;  // next sample streamPending() hands out
+    size_t end_ = 0;       // one past the last sample, once ready
+    uint32_t originUs_ = 0;
+    uint32_t endUs_ = 0;
+    uint32_t preRollUs_ = 1000000;
+    uint32_t postRollUs_ = 1000000;
+    State state_ = State::Idle;
+    bool truncated_ = false;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,108 @@
+#pragma once
+
+// Capability/config message. Sent in reply to "CFG?" and after every
+// "RATE:<hz>" write so the page always knows the real sample period
+// instead of assuming the legacy 30 Hz grid. Tempo frames stay 1/30 s
+// regardless of the capture rate; the board schedules beeps by time.
+//
+// Layout (little-endian):
+//   0  u8   magic
+//   1  u8   version
+//   2  u8   message type (kMsgConfig)
+//   3  u8   flags (kConfigFlagPreRoll)
+//   4  u32  actual sample period in microseconds
+//   8  u32  sample timer clock in Hz
+//   12 u32  tempo frame length in microseconds
+//   16 u16  highest supported sample rate in Hz
+//   18 u16  pre-roll in milliseconds: where Start sits on the swing's
+//           time axis. Only meaningful with kConfigFlagPreRoll; older
+//           boards send 0 here and start 1 s in.
+//   20 u8   load cells on the pad; more than 2 means "COP:ON" is
+//           available (see pressure_center.h)
+//   21 u8   reserved
+//   22 u16  pad width in millimetres, 0 if unknown
+//   24 u16  pad length in millimetres, 0 if unknown
+// Older boards send only the first 20 bytes.
+
+#include <stdlib.h>
+
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgConfig = 0x04;
+constexpr uint8_t kConfigFlagPreRoll = 0x01;  // bytes 18-19 hold the pre-roll, which may be 0
+constexpr size_t kConfigFrameSize = 26;
+constexpr uint32_t kTempoFrameUs = 33333;
+
+struct DeviceConfig {
+    uint32_t timerClockHz = 1000000;
+    uint16_t rateHz = 30;
+    uint16_t maxRateHz = 500;
+    // Capture window around START_SWING .. IMPACT_BEEP (see capture_window.h).
+    uint16_t preRollMs = 1000;
+    uint16_t postRollMs = 1000;
+    // Pad geometry for the page's COP plot (CenterOfPressureSource::describe()).
+    uint8_t cellCount = 2;
+    uint16_t padWidthMm = 0;
+    uint16_t padLengthMm = 0;
+
+    // The timer alarm is an integer number of clock ticks, so this is the
+    // period the board really samples at, not 1 / rateHz.
+    uint32_t samplePeriodUs() const {
+        uint64_t alarmTicks = timerClockHz / rateHz;
+        return static_cast<uint32_t>(alarmTicks * 1000000ULL / timerClockHz);
+    }
+};
+
+inline size_t encodeConfigFrame(const DeviceConfig& cfg, uint8_t* out, size_t cap) {
+    if (cap < kConfigFrameSize) return 0;
+    out[0] = kFrameMagic;
+    out[1] = kFrameVersion;
+    out[2] = kMsgConfig;
+    out[3] = kConfigFlagPreRoll;
+    putU32(out + 4, cfg.samplePeriodUs());
+    putU32(out + 8, cfg.timerClockHz);
+    putU32(out + 12, kTempoFrameUs);
+    putU16(out + 16, cfg.maxRateHz);
+    putU16(out + 18, cfg.preRollMs);
+    out[20] = cfg.cellCount;
+    out[21] = 0;
+    putU16(out + 22, cfg.padWidthMm);
+    putU16(out + 24, cfg.padLengthMm);
+    return kConfigFrameSize;
+}
+
+inline bool isConfigQuery(const char* cmd) {
+    return strcmp(cmd, "CFG?") == 0;
+}
+
+// Parses "RATE:<hz>" and clamps it into [1, maxRateHz]. Returns false for
+// anything else so the caller can fall through to tempo parsing.
+inline bool parseRateCommand(const char* cmd, DeviceConfig& cfg) {
+    if (strncmp(cmd, "RATE:", 5) != 0) return false;
+    char* end = nullptr;
+    long hz = strtol(cmd + 5, &end, 10);
+    if (end == cmd + 5 || *end != '\0') return false;
+    if (hz < 1) hz = 1;
+    if (hz > cfg.maxRateHz) hz = cfg.maxRateHz;
+    cfg.rateHz = static_cast<uint16_t>(hz);
+    return true;
+}
+
+// Parses "ROLL:<pre ms>,<post ms>". The capture window clamps the values to
+// what its buffer holds at the current rate.
+inline bool parseRollCommand(const char* cmd, DeviceConfig& cfg) {
+    if (strncmp(cmd, "ROLL:", 5) != 0) return false;
+    char* end = nullptr;
+    long pre = strtol(cmd + 5, &end, 10);
+    if (end == cmd + 5 || *end != ',') return false;
+    const char* postAt = end + 1;
+    long post = strtol(postAt, &end, 10);
+    if (end == postAt || *end != '\0' || pre < 0 || post < 0) return false;
+    cfg.preRollMs = static_cast<uint16_t>(pre > UINT16_MAX ? UINT16_MAX : pre);
+    cfg.postRollMs = static_cast<uint16_t>(post > UINT16_MAX ? UINT16_MAX : post);
+    return true;
+}
+
+}  // namespace pressurepad
@@ -0,0 +1,219 @@
+#pragma once
+
+// Board diagnostics on their own characteristic, so an odd-looking swing
+// can be traced to samples dropped on a full ring, timer ticks the sampler
+// missed, slow sample reads or a link that kept refusing notifications.
+// Everything is counted, nothing is logged: per sample the sampling
+// context pays two clock reads and a handful of relaxed atomic loads and
+// stores.
+//
+// Sample timing (min/avg/max read time, worst timer-to-task wake latency)
+// covers one report window and restarts after each report; the counters
+// and both high-water marks run since boot. Reports are only sent while
+// the page asks for them:
+//
+//   page -> board  "DIAG?"       one report now
+//   page -> board  "DIAG:<ms>"   a report every <ms>, 0 stops
+//
+// While the board is idle (idle_mode.h) periodic reports are held back to
+// one per kIdleReportMs; the counters keep running, so the next report
+// still covers everything since the last one.
+//
+// Layout (little-endian):
+//   0  u8   magic
+//   1  u8   version
+//   2  u8   message type (kMsgDiagnostics)
+//   3  u8   flags: kDiagIdle while the board samples at the idle rate
+//   4  u16  report sequence number
+//   6  u16  ring capacity, samples
+//   8  u16  ring high-water, samples
+//  10  u16  sample read min, us
+//  12  u16  sample read avg, us
+//  14  u16  sample read max, us
+//  16  u16  wake latency max, us
+//  18  u16  reserved
+//  20  u32  samples timed in this window
+//  24  u32  samples dropped, ring full
+//  28  u32  timer ticks missed
+//  32  u32  notification retries
+//  36  u32  free heap, bytes
+//  40  u32  lowest free heap since boot, bytes
+//
+//   Diagnostics diagnostics;
+//   Esp32Sampler<Engine> sampler(engine, &diagnostics.timing());
+//   send path:    while (!trySend(p, n)) diagnostics.noteNotifyRetry();
+//   on a write:   diagnostics.handleCommand(cmd);
+//   every loop:   if (diagnostics.due(millis())) {
+//                     size_t n = diagnostics.encode(out, sizeof out, engine, sampler.missedTicks(), heapStats());
+//                     diagChar->setValue(out, n); diagChar->notify();
+//                 }
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr const char* kDiagnosticsCharUuid = "6e3f1a52-8c1d-4b7e-9a0f-3d52c8e4b719";
+constexpr uint8_t kMsgDiagnostics = 0x09;
+constexpr size_t kDiagnosticsFrameSize = 44;
+constexpr uint8_t kDiagIdle = 0x01;
+constexpr uint32_t kIdleReportMs = 10000;
+
+struct HeapStats {
+    uint32_t freeBytes = 0;
+    uint32_t minFreeBytes = 0;
+};
+
+// Written by the sampling context only; read by the BLE task.
+class SampleTiming {
+public:
+    struct Window {
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t avgUs;
+        uint32_t maxUs;
+        uint32_t wakeMaxUs;
+    };
+
+    // Sampling context: time spent in one CaptureEngine::sample() and how
+    // long after the timer tick it started.
+    void record(uint32_t readUs, uint32_t wakeUs) {
+        if (restart_.load(std::memory_order_acquire)) {
+            restart_.store(false, std::memory_order_relaxed);
+            min_.store(UINT32_MAX, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+            wakeMax_.store(0, std::memory_order_relaxed);
+            sum_.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+        }
+        // Single writer, so plain load/store pairs instead of RMW atomics.
+        if (readUs < min_.load(std::memory_order_relaxed)) min_.store(readUs, std::memory_order_relaxed);
+        if (readUs > max_.load(std::memory_order_relaxed)) max_.store(readUs, std::memory_order_relaxed);
+        if (wakeUs > wakeMax_.load(std::memory_order_relaxed)) wakeMax_.store(wakeUs, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + readUs, std::memory_order_relaxed);
+        count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // BLE task: the window so far; the next sample starts a new one. A
+    // sample landing during the read may be counted in either window.
+    Window take() {
+        Window w;
+        w.count = count_.load(std::memory_order_relaxed);
+        const uint32_t sum = sum_.load(std::memory_order_relaxed);
+        w.minUs = w.count ? min_.load(std::memory_order_relaxed) : 0;
+        w.maxUs = max_.load(std::memory_order_relaxed);
+        w.avgUs = w.count ? sum / w.count : 0;
+        w.wakeMaxUs = wakeMax_.load(std::memory_order_relaxed);
+        restart_.store(true, std::memory_order_release);
+        return w;
+    }
+
+private:
+    std::atomic<uint32_t> min_{UINT32_MAX};
+    std::atomic<uint32_t> max_{0};
+    std::atomic<uint32_t> wakeMax_{0};
+    std::atomic<uint32_t> sum_{0};
+    std::atomic<uint32_t> count_{0};
+    std::atomic<bool> restart_{false};
+};
+
+class Diagnostics {
+public:
+    SampleTiming& timing() { return timing_; }
+
+    // BLE task: a notification that had to be retried (stack out of
+    // buffers or the link congested).
+    void noteNotifyRetry() { notifyRetries_++; }
+
+    // BLE task: follows the idle controller's wake and sleep.
+    void setIdle(bool idle) { idle_ = idle; }
+
+    // Handles "DIAG?" and "DIAG:<ms>"; returns false for anything else so
+    // the caller can fall through.
+    bool handleCommand(const char* cmd) {
+        if (strcmp(cmd, "DIAG?") == 0) {
+            reportNow_ = true;
+            return true;
+        }
+        if (strncmp(cmd, "DIAG:", 5) != 0) return false;
+        char* end = nullptr;
+        unsigned long ms = strtoul(cmd + 5, &end, 10);
+        if (end == cmd + 5 || *end != '\0') return false;
+        intervalMs_ = ms > UINT16_MAX ? UINT16_MAX : static_cast<uint32_t>(ms);
+        reportNow_ = intervalMs_ != 0;
+        return true;
+    }
+
+    // BLE task, every loop: true when a report should go out now.
+    bool due(uint32_t nowMs) {
+        const uint32_t interval = idle_ && intervalMs_ != 0 && intervalMs_ < kIdleReportMs ? kIdleReportMs : intervalMs_;
+        if (reportNow_ || (interval != 0 && nowMs - lastReportMs_ >= interval)) {
+            reportNow_ = false;
+            lastReportMs_ = nowMs;
+            return true;
+        }
+        return false;
+    }
+
+    // Engine is a CaptureEngine (dropped(), highWater(), ringCapacity()).
+    template <typename Engine>
+    size_t encode(uint8_t* out, size_t cap, const Engine& engine, uint32_t missedTicks, HeapStats heap) {
+        if (cap < kDiagnosticsFrameSize) return 0;
+        const SampleTiming::Window w = timing_.take();
+        out[0] = kFrameMagic;
+        out[1] = kFrameVersion;
+        out[2] = kMsgDiagnostics;
+        out[3] = idle_ ? kDiagIdle : 0;
+        putU16(out + 4, seq_++);
+        putU16(out + 6, saturate16(engine.ringCapacity()));
+        putU16(out + 8, saturate16(engine.highWater()));
+        putU16(out + 10, saturate16(w.minUs));
+        putU16(out + 12, saturate16(w.avgUs));
+        putU16(out + 14, saturate16(w.maxUs));
+        putU16(out + 16, saturate16(w.wakeMaxUs));
+        putU16(out + 18, 0);
+        putU32(out + 20, w.count);
+        putU32(out + 24, engine.dropped());
+        putU32(out + 28, missedTicks);
+        putU32(out + 32, notifyRetries_);
+        putU32(out + 36, heap.freeBytes);
+        putU32(out + 40, heap.minFreeBytes);
+        return kDiagnosticsFrameSize;
+    }
+
+private:
+    static uint16_t saturate16(size_t v) { return v > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(v); }
+
+    SampleTiming timing_;
+    uint32_t notifyRetries_ = 0;
+    uint32_t intervalMs_ = 0;
+    uint32_t lastReportMs_ = 0;
+    uint16_t seq_ = 0;
+    bool reportNow_ = false;
+    bool idle_ = false;
+};
+
+}  // namespace pressurepad
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <esp_heap_caps.h>
+
+namespace pressurepad {
+
+inline HeapStats heapStats() {
+    HeapStats heap;
+    heap.freeBytes = static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
+    heap.minFreeBytes = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT));
+    return heap;
+}
+
+}  // namespace pressurepad
+
+#endif  // ARDUINO_ARCH_ESP32
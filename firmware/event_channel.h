@@ -0,0 +1,66 @@
+#pragma once
+
+// Control events on their own characteristic, so a beep notification never
+// waits behind queued sample chunks on the data characteristic. Each event
+// carries the capture clock (the same timebase as SwingSample::tUs), which
+// lets the page draw Top/Impact where the beeps really fired.
+//
+// Layout (little-endian):
+//   0  u8   magic
+//   1  u8   version
+//   2  u8   message type (kMsgEvent)
+//   3  u8   event code
+//   4  u16  event sequence number
+//   6  u16  reserved
+//   8  u32  time since capture start, microseconds
+// Boards without this characteristic keep sending the event names as text
+// on the data characteristic.
+
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr const char* kEventCharUuid = "1c95d5e3-d8f7-413a-bf3d-7a2e5d7be87e";
+constexpr uint8_t kMsgEvent = 0x06;
+constexpr size_t kEventFrameSize = 12;
+
+enum class EventCode : uint8_t {
+    WeightDetected = 1,
+    StartSwing = 2,
+    TopBeep = 3,
+    ImpactBeep = 4,
+    SteppedOff = 5,
+};
+
+// Legacy text name for boards and pages that still use the data
+// characteristic.
+inline const char* eventName(EventCode code) {
+    switch (code) {
+        case EventCode::WeightDetected: return "WEIGHT_DETECTED";
+        case EventCode::StartSwing: return "START_SWING";
+        case EventCode::TopBeep: return "TOP_BEEP";
+        case EventCode::ImpactBeep: return "IMPACT_BEEP";
+        case EventCode::SteppedOff: return "STEPPED_OFF";
+    }
+    return "";
+}
+
+class EventEncoder {
+public:
+    size_t encode(EventCode code, uint32_t tUs, uint8_t* out, size_t cap) {
+        if (cap < kEventFrameSize) return 0;
+        out[0] = kFrameMagic;
+        out[1] = kFrameVersion;
+        out[2] = kMsgEvent;
+        out[3] = static_cast<uint8_t>(code);
+        putU16(out + 4, seq_++);
+        putU16(out + 6, 0);
+        putU32(out + 8, tUs);
+        return kEventFrameSize;
+    }
+
+private:
+    uint16_t seq_ = 0;
+};
+
+}  // namespace pressurepad
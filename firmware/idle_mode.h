@@ -0,0 +1,105 @@
+#pragma once
+
+// Low-power idle between swings. With nobody on the pad the board samples
+// at kIdleRateHz instead of the capture rate, holds diagnostics reports
+// back (see Diagnostics::setIdle()) and asks the central for a slow
+// connection interval with peripheral latency, so the radio can miss most
+// connection events (requestIdleLink() in ble_link.h). Nothing else is
+// notified while idle: samples only go out inside a swing window.
+//
+// Wake-up is a weight threshold on the drained samples: kWakeSamples in a
+// row with at least kWakeGrams on the pad switch back to the capture rate
+// and the fast link. At 25 Hz that is under 100 ms after stepping on, and
+// the same samples then reach the WEIGHT_DETECTED check, so the page's
+// countdown starts as before. START_SWING comes 5 s later, long after the
+// pre-roll has filled at full rate and the link has sped up. The board
+// goes idle again once the pad has stayed below kEmptyPadGrams for the
+// idle timeout outside a swing window.
+//
+//   page -> board  "IDLE:<ms>"   idle timeout, 0 keeps the board at full rate
+//
+//   IdleController idle;
+//   engine.drain([&](const SwingSample& s) { window.push(s); idle.poll(s); ... });
+//   every loop:
+//     switch (idle.update(millis(), window.state() != CaptureWindow<4096>::State::Idle)) {
+//         case IdleChange::Wake:  sampler.setRate(cfg.rateHz); cells.setSampleRate(cfg.rateHz); requestFastLink(peer); diagnostics.setIdle(false); break;
+//         case IdleChange::Sleep: sampler.setRate(kIdleRateHz); cells.setSampleRate(kIdleRateHz); requestIdleLink(peer); diagnostics.setIdle(true); break;
+//         case IdleChange::None:  break;
+//     }
+//   on a write:   idle.handleCommand(cmd);
+//   RATE:<hz>:    if (!idle.idle()) { sampler.setRate(cfg.rateHz); cells.setSampleRate(cfg.rateHz); }
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "load_cell_calibration.h"
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint16_t kIdleRateHz = 25;
+// Well above kEmptyPadGrams, so sensor noise around the empty-pad level
+// cannot wake the board.
+constexpr int32_t kWakeGrams = 5000;
+constexpr uint8_t kWakeSamples = 2;
+constexpr uint32_t kDefaultIdleAfterMs = 30000;
+
+enum class IdleChange : uint8_t { None, Wake, Sleep };
+
+// BLE task only.
+class IdleController {
+public:
+    bool idle() const { return idle_; }
+    uint32_t idleAfterMs() const { return idleAfterMs_; }
+
+    // Every drained sample.
+    void poll(const SwingSample& s) {
+        const int32_t total = (s.leadGrams > 0 ? s.leadGrams : 0) + (s.trailGrams > 0 ? s.trailGrams : 0);
+        if (total >= kWakeGrams) {
+            if (above_ < kWakeSamples) above_++;
+        } else {
+            above_ = 0;
+        }
+        if (above_ >= kWakeSamples) loaded_ = true;
+        if (total < kEmptyPadGrams) loaded_ = false;
+    }
+
+    // Every loop. `busy` is true while a swing window is open or still
+    // being sent; the board never drops to the idle rate in the middle of
+    // one.
+    IdleChange update(uint32_t nowMs, bool busy) {
+        if (idle_) {
+            if (!loaded_ && idleAfterMs_ != 0) return IdleChange::None;
+            idle_ = false;
+            emptySinceMs_ = nowMs;
+            return IdleChange::Wake;
+        }
+        if (loaded_ || busy) emptySinceMs_ = nowMs;
+        if (idleAfterMs_ == 0 || nowMs - emptySinceMs_ < idleAfterMs_) return IdleChange::None;
+        idle_ = true;
+        return IdleChange::Sleep;
+    }
+
+    // Handles "IDLE:<ms>"; returns false for anything else so the caller
+    // can fall through. "IDLE:0" also wakes an idle board on the next
+    // update().
+    bool handleCommand(const char* cmd) {
+        if (strncmp(cmd, "IDLE:", 5) != 0) return false;
+        char* end = nullptr;
+        unsigned long ms = strtoul(cmd + 5, &end, 10);
+        if (end == cmd + 5 || *end != '\0') return false;
+        idleAfterMs_ = static_cast<uint32_t>(ms);
+        return true;
+    }
+
+private:
+    uint32_t idleAfterMs_ = kDefaultIdleAfterMs;
+    uint32_t emptySinceMs_ = 0;
+    uint8_t above_ = 0;
+    bool loaded_ = false;
+    bool idle_ = false;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,311 @@
+#pragma once
+
+// Load-cell calibration between the raw ADC read and CaptureEngine, so the
+// samples that reach the ring, the summary and the wire are already clean
+// grams. CalibratedSource wraps a raw source and is itself a CaptureEngine
+// Source; everything it does per sample is integer adds, shifts and one
+// 64-bit multiply per cell, well inside the sampling budget.
+//
+// Per cell, in order:
+//   1. median of the last three raw counts, which removes single-sample
+//      spikes from the HX711 / ADC
+//   2. first-order IIR, y += (x - y) >> iirShift, state kept with
+//      kFilterFractionBits extra bits so small shifts do not truncate
+//   3. grams = (filtered - tare) * gain, gain in Q20 grams/count; the tare
+//      starts at the flash offset and is re-latched at runtime
+//
+// Offset and gain come from flash (loadCalibration() on ESP32). Tare
+// follows drift at runtime: while the pad is empty a slow baseline tracks
+// the filtered counts, and tare() latches that baseline. Call it on
+// WEIGHT_DETECTED; it uses the empty-pad reading from just before the
+// golfer stepped on, so the stance weight itself is never zeroed.
+//
+// The baseline has a time constant of about kBaselineTimeConstantMs at
+// any sample rate; setSampleRate() keeps it there when the rate changes.
+// "Empty" means under kEmptyPadGrams in total, so anything lighter left
+// lying on the pad (a club, a phone) is indistinguishable from drift and
+// is tared away within a few time constants. Stepping on moves the
+// baseline only by the fraction of a time constant the load spends
+// under that threshold.
+//
+// Raw source must provide `void readRaw(int32_t& leadCounts, int32_t& trailCounts)`,
+// or `void readRaw(int32_t* counts)` filling Cells counts for a pad with more
+// load cells (see pressure_center.h).
+//
+//   CalibratedSource<Hx711Pair> cells(hx711);
+//   loadCalibration(cells);
+//   CaptureEngine<CalibratedSource<Hx711Pair>> engine(cells);
+//   cells.setSampleRate(cfg.rateHz);  and again wherever sampler.setRate() is called
+//   on WEIGHT_DETECTED:  cells.tare();
+//   on a write:          if (parseCalibrationCommand(cmd, cells) == CalibrationCommand::Changed)
+//                            saveCalibration(cells);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+namespace pressurepad {
+
+constexpr int kGainFractionBits = 20;
+constexpr int kFilterFractionBits = 4;
+constexpr uint8_t kDefaultIirShift = 2;
+// Calibrated total below which the pad counts as empty for the baseline.
+constexpr int32_t kEmptyPadGrams = 2000;
+// The empty-pad baseline moves 1/2^shift of the way per sample, with the
+// shift chosen from the sample rate (baselineShiftFor()). It keeps
+// kBaselineFractionBits more than the filter so that large shifts still
+// follow slow drift instead of stalling on the truncation.
+constexpr uint32_t kBaselineTimeConstantMs = 2000;
+constexpr int kBaselineFractionBits = 16;
+constexpr uint8_t kDefaultBaselineShift = 6;  // 30 Hz
+constexpr size_t kCellCount = 2;
+
+struct CellCalibration {
+    int32_t offsetCounts = 0;
+    int32_t gainQ20 = 1 << kGainFractionBits;  // grams per count
+};
+
+inline int32_t median3(int32_t a, int32_t b, int32_t c) {
+    if (a > b) {
+        int32_t t = a;
+        a = b;
+        b = t;
+    }
+    if (b > c) b = c;
+    return a > b ? a : b;
+}
+
+// Smallest shift whose 2^shift samples span the baseline time constant.
+inline uint8_t baselineShiftFor(uint32_t rateHz) {
+    const uint64_t samples = static_cast<uint64_t>(rateHz) * kBaselineTimeConstantMs / 1000;
+    uint8_t shift = 0;
+    while (shift < 20 && (uint64_t{1} << shift) < samples) shift++;
+    return shift;
+}
+
+class CellFilter {
+public:
+    // Returns the filtered reading in counts << kFilterFractionBits.
+    int32_t push(int32_t raw, uint8_t iirShift) {
+        int32_t m = median3(prev2_, prev_, raw);
+        if (!primed_) {
+            m = raw;
+            prev2_ = prev_ = raw;
+            state_ = raw * (1 << kFilterFractionBits);
+            primed_ = true;
+        }
+        prev2_ = prev_;
+        prev_ = raw;
+        state_ += (m * (1 << kFilterFractionBits) - state_) >> iirShift;
+        return state_;
+    }
+
+private:
+    int32_t prev_ = 0;
+    int32_t prev2_ = 0;
+    int32_t state_ = 0;
+    bool primed_ = false;
+};
+
+template <typename RawSource, size_t Cells = kCellCount>
+class CalibratedSource {
+    static_assert(Cells >= 2, "a pad has at least a lead and a trail cell");
+
+public:
+    static constexpr size_t kCells = Cells;
+
+    explicit CalibratedSource(RawSource& raw) : raw_(raw) {}
+
+    // Sampling context.
+    void read(int32_t& leadGrams, int32_t& trailGrams) {
+        int32_t grams[Cells];
+        readCells(grams);
+        leadGrams = grams[0];
+        trailGrams = grams[1];
+    }
+
+    // Sampling context: every cell, calibrated, in the raw source's order.
+    void readCells(int32_t* grams) {
+        int32_t counts[Cells];
+        if constexpr (Cells == 2) {
+            raw_.readRaw(counts[0], counts[1]);
+        } else {
+            raw_.readRaw(counts);
+        }
+        const uint8_t shift = iirShift_.load(std::memory_order_relaxed);
+        const uint8_t baselineShift = baselineShift_.load(std::memory_order_relaxed);
+        const bool latchTare = tareRequested_.exchange(false, std::memory_order_acquire);
+        int32_t total = 0;
+        for (size_t i = 0; i < Cells; i++) {
+            Cell& cell = cells_[i];
+            const int32_t filtered = cell.filter.push(counts[i], shift);
+            if (!cell.baselineValid) {
+                cell.baseline = static_cast<int64_t>(filtered) << kBaselineFractionBits;
+                cell.baselineValid = true;
+            }
+            if (latchTare) {
+                cell.tare.store(static_cast<int32_t>(cell.baseline >> kBaselineFractionBits), std::memory_order_relaxed);
+            }
+            cell.filtered.store(filtered, std::memory_order_relaxed);
+            grams[i] = toGrams(cell, filtered);
+            total += grams[i];
+        }
+        // Only an empty pad moves the baseline, so standing still on it is
+        // never mistaken for drift.
+        if (total < kEmptyPadGrams) {
+            for (Cell& cell : cells_) {
+                const int64_t filtered = static_cast<int64_t>(cell.filtered.load(std::memory_order_relaxed))
+                                         << kBaselineFractionBits;
+                cell.baseline += (filtered - cell.baseline) >> baselineShift;
+            }
+        }
+    }
+
+    // Any task: the next sample latches the current empty-pad baseline.
+    void tare() { tareRequested_.store(true, std::memory_order_release); }
+
+    void setIirShift(uint8_t shift) { iirShift_.store(shift > 8 ? 8 : shift, std::memory_order_relaxed); }
+
+    // Any task: the rate the raw source is now read at.
+    void setSampleRate(uint32_t rateHz) {
+        baselineShift_.store(baselineShiftFor(rateHz), std::memory_order_relaxed);
+    }
+
+    CellCalibration calibration(size_t cell) const {
+        CellCalibration c;
+        c.offsetCounts = cells_[cell].offset.load(std::memory_order_relaxed);
+        c.gainQ20 = cells_[cell].gain.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    void setCalibration(size_t cell, const CellCalibration& c) {
+        cells_[cell].offset.store(c.offsetCounts, std::memory_order_relaxed);
+        cells_[cell].gain.store(c.gainQ20, std::memory_order_relaxed);
+        cells_[cell].tare.store(c.offsetCounts * (1 << kFilterFractionBits), std::memory_order_relaxed);
+    }
+
+    // Two-point calibration with the current reading: 0 g makes it the
+    // cell's zero, a known load sets the gain against that zero. Returns
+    // false when the load reads as no change from zero.
+    bool calibrateCell(size_t cell, int32_t knownGrams) {
+        Cell& c = cells_[cell];
+        const int32_t counts = c.filtered.load(std::memory_order_relaxed) >> kFilterFractionBits;
+        if (knownGrams == 0) {
+            CellCalibration zero = calibration(cell);
+            zero.offsetCounts = counts;
+            setCalibration(cell, zero);
+            return true;
+        }
+        const int32_t span = counts - c.offset.load(std::memory_order_relaxed);
+        if (span == 0) return false;
+        c.gain.store(static_cast<int32_t>((static_cast<int64_t>(knownGrams) << kGainFractionBits) / span),
+                     std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    struct Cell {
+        CellFilter filter;
+        // counts << (kFilterFractionBits + kBaselineFractionBits), sampling context only
+        int64_t baseline = 0;
+        bool baselineValid = false;
+        std::atomic<int32_t> filtered{0};
+        std::atomic<int32_t> tare{0};  // counts << kFilterFractionBits
+        std::atomic<int32_t> offset{0};
+        std::atomic<int32_t> gain{1 << kGainFractionBits};
+    };
+
+    // The tare already includes the flash offset; the offset only matters
+    // until the first tare and as the zero for calibrateCell().
+    static int32_t toGrams(const Cell& cell, int32_t filtered) {
+        const int32_t net = filtered - cell.tare.load(std::memory_order_relaxed);
+        const int64_t grams = (static_cast<int64_t>(net) * cell.gain.load(std::memory_order_relaxed)) >>
+                              (kGainFractionBits + kFilterFractionBits);
+        return static_cast<int32_t>(grams);
+    }
+
+    RawSource& raw_;
+    Cell cells_[Cells];
+    std::atomic<bool> tareRequested_{false};
+    std::atomic<uint8_t> iirShift_{kDefaultIirShift};
+    std::atomic<uint8_t> baselineShift_{kDefaultBaselineShift};
+};
+
+enum class CalibrationCommand : uint8_t { None, Applied, Changed };
+
+// Parses "TARE", "FILTER:<shift>" and "CAL:<cell>:<grams>", where the cell
+// is L, T or, on pads with more cells, its index. Changed means the flash
+// calibration should be saved; None lets the caller fall through to its
+// other commands.
+template <typename Source>
+CalibrationCommand parseCalibrationCommand(const char* cmd, Source& cells) {
+    if (strcmp(cmd, "TARE") == 0) {
+        cells.tare();
+        return CalibrationCommand::Applied;
+    }
+    char* end = nullptr;
+    if (strncmp(cmd, "FILTER:", 7) == 0) {
+        long shift = strtol(cmd + 7, &end, 10);
+        if (end == cmd + 7 || *end != '\0' || shift < 0) return CalibrationCommand::None;
+        cells.setIirShift(static_cast<uint8_t>(shift > 8 ? 8 : shift));
+        return CalibrationCommand::Applied;
+    }
+    if (strncmp(cmd, "CAL:", 4) != 0 || cmd[5] != ':') return CalibrationCommand::None;
+    size_t cell;
+    if (cmd[4] == 'L') {
+        cell = 0;
+    } else if (cmd[4] == 'T') {
+        cell = 1;
+    } else if (cmd[4] >= '0' && cmd[4] <= '9' && static_cast<size_t>(cmd[4] - '0') < Source::kCells) {
+        cell = static_cast<size_t>(cmd[4] - '0');
+    } else {
+        return CalibrationCommand::None;
+    }
+    long grams = strtol(cmd + 6, &end, 10);
+    if (end == cmd + 6 || *end != '\0') return CalibrationCommand::None;
+    return cells.calibrateCell(cell, static_cast<int32_t>(grams)) ? CalibrationCommand::Changed
+                                                                  : CalibrationCommand::Applied;
+}
+
+}  // namespace pressurepad
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Preferences.h>
+
+namespace pressurepad {
+
+// Calibration lives in NVS as one blob per cell, so a board keeps its
+// gains across flashing new firmware.
+constexpr const char* kCalibrationNamespace = "pressurepad";
+
+template <typename Source>
+void loadCalibration(Source& cells) {
+    Preferences prefs;
+    if (!prefs.begin(kCalibrationNamespace, true)) return;
+    for (size_t i = 0; i < Source::kCells; i++) {
+        const char key[] = {'c', 'a', 'l', static_cast<char>('0' + i), '\0'};
+        CellCalibration c;
+        if (prefs.getBytes(key, &c, sizeof c) == sizeof c && c.gainQ20 != 0) cells.setCalibration(i, c);
+    }
+    prefs.end();
+}
+
+template <typename Source>
+void saveCalibration(const Source& cells) {
+    Preferences prefs;
+    if (!prefs.begin(kCalibrationNamespace, false)) return;
+    for (size_t i = 0; i < Source::kCells; i++) {
+        const char key[] = {'c', 'a', 'l', static_cast<char>('0' + i), '\0'};
+        const CellCalibration c = cells.calibration(i);
+        prefs.putBytes(key, &c, sizeof c);
+    }
+    prefs.end();
+}
+
+}  // namespace pressurepad
+
+#endif  // ARDUINO_ARCH_ESP32
@@ -0,0 +1,236 @@
+#pragma once
+
+// Center-of-pressure mode for pads with more than two load cells. Every
+// cell sits at a known position under one foot; per sample the lead and
+// trail channels are the sums over each foot's cells, and the center of
+// pressure is the load-weighted mean of the cell positions:
+//
+//   copX = sum(g[i] * x[i]) / sum(g[i]),  likewise for y
+//
+// It is computed on the board, so with "COP:ON" (kFlagCenterOfPressure) a
+// swing grows by two columns per sample however many cells the pad has.
+// Cells read as negative count as 0, and below kEmptyPadGrams in total
+// the COP is kCopNone.
+//
+// Per sample that is Cells multiply-adds in 32-bit integers and two
+// divides. The loop is left to the compiler on purpose: with at most
+// kMaxCells cells it unrolls into a few MULL/ADD pairs, which costs less
+// than setting up an esp-dsp dot product (dsps_dotprod_s16 wants 16-bit
+// inputs and only pays off from dozens of elements) and needs no vector
+// unit, so it runs the same on every ESP32 variant.
+//
+// Raw cell weights are off by default. After "CELLS:ON" the sampling
+// context also queues each sample's cells in a separate ring, and the BLE
+// task sends them as kMsgCells frames once the swing's own frames are out.
+// A full ring drops cell samples (counted, and visible on the page as
+// skipped sequence numbers), never swing samples.
+//
+//   page -> board  "COP:ON" / "COP:OFF"      COP columns in swing frames
+//   page -> board  "CELLS:ON" / "CELLS:OFF"  raw cell upload
+//
+// kMsgCells layout: a frame header with flags = cell count, reserved =
+// frame sequence number and t0 = first sample time in ticks on the capture
+// clock, then u16 tick deltas and one i16 weight column per cell, in the
+// layout's cell order, fixed-width.
+//
+//   CalibratedSource<Hx711Quad, 4> cells(hx711);
+//   CenterOfPressureSource<CalibratedSource<Hx711Quad, 4>, 4> pad(cells, kFourCellPad);
+//   CaptureEngine<decltype(pad)> engine(pad);
+//   pad.describe(deviceConfig);                        // before the config reply
+//   on a write:   if (pad.handleCommand(cmd, frameConfig)) streamer.setConfig(frameConfig);
+//   every loop:   after the stream chunks, pad.sendCells(frameConfig, send);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "device_config.h"
+#include "load_cell_calibration.h"
+#include "spsc_ring.h"
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgCells = 0x0A;
+constexpr size_t kMaxCells = 8;
+// Bounds that keep sum(g[i] * x[i]) inside int32 for kMaxCells cells.
+constexpr int32_t kMaxCellGrams = 250000;
+constexpr int16_t kMaxCellOffsetMm = 1000;
+
+enum class Foot : uint8_t { Lead, Trail };
+
+// Position from the pad center: lead foot towards +x, toes towards +y.
+struct CellPosition {
+    int16_t xMm;
+    int16_t yMm;
+    Foot foot;
+};
+
+template <size_t Cells>
+struct PadLayout {
+    uint16_t widthMm;
+    uint16_t lengthMm;
+    CellPosition cells[Cells];
+};
+
+// Heel and toe cell under each foot.
+constexpr PadLayout<4> kFourCellPad = {
+    800, 400, {{200, -120, Foot::Lead}, {200, 120, Foot::Lead}, {-200, -120, Foot::Trail}, {-200, 120, Foot::Trail}}};
+
+// Heel and toe, inside and outside edge, under each foot.
+constexpr PadLayout<8> kEightCellPad = {800,
+                                        400,
+                                        {{120, -120, Foot::Lead},
+                                         {120, 120, Foot::Lead},
+                                         {300, -120, Foot::Lead},
+                                         {300, 120, Foot::Lead},
+                                         {-120, -120, Foot::Trail},
+                                         {-120, 120, Foot::Trail},
+                                         {-300, -120, Foot::Trail},
+                                         {-300, 120, Foot::Trail}}};
+
+template <size_t Cells>
+struct CellSample {
+    uint32_t tUs;
+    int32_t grams[Cells];
+};
+
+// CellSource must provide `void readCells(int32_t* grams)` for Cells cells,
+// as CalibratedSource<RawSource, Cells> does.
+template <typename CellSource, size_t Cells, size_t RingCapacity = 256, size_t BatchSize = 8>
+class CenterOfPressureSource {
+    static_assert(Cells > 2 && Cells <= kMaxCells, "COP mode is for pads with 3 to kMaxCells cells");
+
+public:
+    static constexpr size_t kCellsFrameBytes = kFrameHeaderSize + BatchSize * (1 + Cells) * 2;
+
+    CenterOfPressureSource(CellSource& cells, const PadLayout<Cells>& layout) : cells_(cells), layout_(layout) {
+        // Positions past kMaxCellOffsetMm could overflow the sums.
+        for (CellPosition& c : layout_.cells) {
+            c.xMm = clampOffset(c.xMm);
+            c.yMm = clampOffset(c.yMm);
+        }
+    }
+
+    // Sampling context: `s.tUs` is already set by CaptureEngine.
+    void read(SwingSample& s) {
+        int32_t grams[Cells];
+        cells_.readCells(grams);
+        int32_t lead = 0;
+        int32_t trail = 0;
+        int32_t total = 0;
+        int32_t sumX = 0;
+        int32_t sumY = 0;
+        for (size_t i = 0; i < Cells; i++) {
+            const CellPosition& c = layout_.cells[i];
+            (c.foot == Foot::Lead ? lead : trail) += grams[i];
+            const int32_t g = grams[i] < 0 ? 0 : (grams[i] > kMaxCellGrams ? kMaxCellGrams : grams[i]);
+            total += g;
+            sumX += g * c.xMm;
+            sumY += g * c.yMm;
+        }
+        s.leadGrams = lead;
+        s.trailGrams = trail;
+        if (total < kEmptyPadGrams) {
+            s.copXMm = kCopNone;
+            s.copYMm = kCopNone;
+        } else {
+            s.copXMm = static_cast<int16_t>(sumX / total);
+            s.copYMm = static_cast<int16_t>(sumY / total);
+        }
+        if (!rawCells_.load(std::memory_order_relaxed)) return;
+        CellSample<Cells> raw;
+        raw.tUs = s.tUs;
+        memcpy(raw.grams, grams, sizeof grams);
+        if (!ring_.push(raw)) droppedCells_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Cell count and pad size for the config message.
+    void describe(DeviceConfig& cfg) const {
+        cfg.cellCount = static_cast<uint8_t>(Cells);
+        cfg.padWidthMm = layout_.widthMm;
+        cfg.padLengthMm = layout_.lengthMm;
+    }
+
+    void setRawCells(bool on) { rawCells_.store(on, std::memory_order_relaxed); }
+    bool rawCells() const { return rawCells_.load(std::memory_order_relaxed); }
+    uint32_t droppedCells() const { return droppedCells_.load(std::memory_order_relaxed); }
+
+    // Handles "COP:ON|OFF" and "CELLS:ON|OFF"; returns false for anything
+    // else so the caller can fall through.
+    bool handleCommand(const char* cmd, FrameConfig& cfg) {
+        if (strcmp(cmd, "COP:ON") == 0) {
+            cfg.flags |= kFlagCenterOfPressure;
+        } else if (strcmp(cmd, "COP:OFF") == 0) {
+            cfg.flags &= static_cast<uint8_t>(~kFlagCenterOfPressure);
+        } else if (strcmp(cmd, "CELLS:ON") == 0) {
+            setRawCells(true);
+        } else if (strcmp(cmd, "CELLS:OFF") == 0) {
+            setRawCells(false);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // BLE task, after the swing's frames for this loop: sends every queued
+    // cell sample through `send(const uint8_t*, size_t)` in kMsgCells frames
+    // of up to BatchSize samples. A gap too long for a 16-bit delta starts a
+    // new frame. Returns the number of frames sent.
+    template <typename Send>
+    size_t sendCells(const FrameConfig& cfg, Send&& send) {
+        if (cfg.tickUs == 0 || cfg.gramsPerLsb == 0) return 0;
+        size_t frames = 0;
+        CellSample<Cells> batch[BatchSize];
+        size_t n = 0;
+        while (true) {
+            while (n < BatchSize && ring_.pop(batch[n])) n++;
+            if (n == 0) return frames;
+            size_t len = 1;
+            while (len < n && tickOf(batch[len], cfg) - tickOf(batch[len - 1], cfg) <= UINT16_MAX) len++;
+            uint8_t out[kCellsFrameBytes];
+            send(out, encodeCells(batch, len, cfg, out));
+            frames++;
+            for (size_t i = len; i < n; i++) batch[i - len] = batch[i];
+            n -= len;
+        }
+    }
+
+private:
+    static int16_t clampOffset(int16_t mm) {
+        return mm > kMaxCellOffsetMm ? kMaxCellOffsetMm : (mm < -kMaxCellOffsetMm ? -kMaxCellOffsetMm : mm);
+    }
+
+    static uint32_t tickOf(const CellSample<Cells>& s, const FrameConfig& cfg) { return s.tUs / cfg.tickUs; }
+
+    size_t encodeCells(const CellSample<Cells>* batch, size_t n, const FrameConfig& cfg, uint8_t* out) {
+        const uint32_t firstTick = tickOf(batch[0], cfg);
+        writeFrameHeader(out, kMsgCells, static_cast<uint8_t>(Cells), static_cast<uint16_t>(n), cfg, firstTick);
+        putU16(out + 10, seq_++);
+        uint8_t* deltas = out + kFrameHeaderSize;
+        uint32_t prevTick = firstTick;
+        for (size_t i = 0; i < n; i++) {
+            const uint32_t tick = tickOf(batch[i], cfg);
+            putU16(deltas + i * 2, static_cast<uint16_t>(tick - prevTick));
+            prevTick = tick;
+        }
+        for (size_t c = 0; c < Cells; c++) {
+            uint8_t* column = deltas + (1 + c) * n * 2;
+            for (size_t i = 0; i < n; i++) {
+                putU16(column + i * 2, static_cast<uint16_t>(toWeightUnits(batch[i].grams[c], cfg.gramsPerLsb)));
+            }
+        }
+        return kFrameHeaderSize + n * (1 + Cells) * 2;
+    }
+
+    CellSource& cells_;
+    PadLayout<Cells> layout_;
+    SpscRing<CellSample<Cells>, RingCapacity> ring_;
+    std::atomic<bool> rawCells_{false};
+    std::atomic<uint32_t> droppedCells_{0};
+    uint16_t seq_ = 0;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,51 @@
+#pragma once
+
+// Lock-free single-producer/single-consumer ring. The sampling context is
+// the only writer and the BLE task the only reader, so head and tail each
+// have exactly one owner and no locks or critical sections are needed.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace pressurepad {
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Producer side. Returns false and leaves the ring untouched when full.
+    bool push(const T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Capacity) return false;
+        slots_[head & (Capacity - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    bool pop(T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        value = slots_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    T slots_[Capacity];
+    alignas(4) std::atomic<size_t> head_{0};
+    alignas(4) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,234 @@
+#pragma once
+
+// Binary swing frame sent on the data characteristic once the page has
+// negotiated it with "FMT:BIN" (or "FMT:STREAM", see swing_stream.h).
+// Boards keep sending the "x1;y1;x2;y2" text lists until then, so older
+// pages keep working.
+//
+// Layout (little-endian):
+//   0  u8   magic (0xB5, never a printable ASCII byte)
+//   1  u8   version
+//   2  u8   message type
+//   3  u8   flags
+//   4  u16  sample count
+//   6  u16  tick length in microseconds
+//   8  u16  grams per weight LSB
+//   10 u16  reserved
+//   12 u32  timestamp of the first sample, in ticks
+//   16 u16  per-sample timestamp deltas in ticks (first is 0)
+//   .. i16  lead weights
+//   .. i16  trail weights
+//   .. u16  lead fraction, Q15, only if kFlagLeadFraction is set
+//   .. i16  center of pressure x, mm, only if kFlagCenterOfPressure is set
+//   .. i16  center of pressure y, mm, likewise (see pressure_center.h)
+// With kFlagPredictedVarint the same columns follow the header as
+// variable-length residual streams instead (see trace_codec.h); stream
+// chunks may also set kFlagCarriedPredictor (see swing_stream.h).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "trace_codec.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kFrameMagic = 0xB5;
+constexpr uint8_t kFrameVersion = 1;
+constexpr uint8_t kMsgSwing = 0x01;
+constexpr size_t kFrameHeaderSize = 16;
+
+constexpr uint8_t kFlagLeadFraction = 0x01;
+constexpr uint8_t kFlagPredictedVarint = 0x02;
+constexpr uint8_t kFlagCenterOfPressure = 0x04;
+constexpr uint8_t kFlagCarriedPredictor = 0x08;
+constexpr uint16_t kLeadFractionOne = 1 << 15;
+constexpr uint16_t kLeadFractionNone = 0xFFFF;  // no weight on the pad
+constexpr int16_t kCopNone = INT16_MIN;         // likewise, for the COP columns
+
+enum class WireFormat : uint8_t { Text, Binary, Stream };
+
+struct SwingSample {
+    uint32_t tUs;  // relative to capture start; the page draws Start at the pre-roll
+    int32_t leadGrams;
+    int32_t trailGrams;
+    // Center of pressure from the pad center, lead foot towards +x, toes
+    // towards +y. Only multi-cell pads fill these in.
+    int16_t copXMm = kCopNone;
+    int16_t copYMm = kCopNone;
+};
+
+struct FrameConfig {
+    uint16_t tickUs = 100;
+    uint16_t gramsPerLsb = 4;
+    uint8_t flags = kFlagLeadFraction;
+};
+
+inline void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, static_cast<uint16_t>(v));
+    putU16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+inline int16_t toWeightUnits(int32_t grams, uint16_t gramsPerLsb) {
+    int32_t units = (grams + (grams >= 0 ? gramsPerLsb / 2 : -(gramsPerLsb / 2))) / gramsPerLsb;
+    if (units > INT16_MAX) return INT16_MAX;
+    if (units < INT16_MIN) return INT16_MIN;
+    return static_cast<int16_t>(units);
+}
+
+// lead / (lead + trail) in Q15, so the page never divides per sample.
+inline uint16_t leadFractionQ15(int32_t leadGrams, int32_t trailGrams) {
+    if (leadGrams < 0) leadGrams = 0;
+    if (trailGrams < 0) trailGrams = 0;
+    int64_t total = static_cast<int64_t>(leadGrams) + trailGrams;
+    if (total == 0) return kLeadFractionNone;
+    return static_cast<uint16_t>((static_cast<int64_t>(leadGrams) * kLeadFractionOne + total / 2) / total);
+}
+
+inline constexpr size_t sampleColumns(uint8_t flags) {
+    return 3 + ((flags & kFlagLeadFraction) ? 1 : 0) + ((flags & kFlagCenterOfPressure) ? 2 : 0);
+}
+
+inline constexpr size_t sampleBytes(uint8_t flags) {
+    return sampleColumns(flags) * ((flags & kFlagPredictedVarint) ? kMaxResidualBytes : 2);
+}
+
+// Exact size for fixed-width frames, upper bound for compressed ones.
+inline size_t swingFrameSize(size_t count, uint8_t flags = 0) {
+    return kFrameHeaderSize + count * sampleBytes(flags);
+}
+
+inline void writeFrameHeader(uint8_t* out, uint8_t type, uint8_t flags, uint16_t count,
+                             const FrameConfig& cfg, uint32_t t0Ticks) {
+    out[0] = kFrameMagic;
+    out[1] = kFrameVersion;
+    out[2] = type;
+    out[3] = flags;
+    putU16(out + 4, count);
+    putU16(out + 6, cfg.tickUs);
+    putU16(out + 8, cfg.gramsPerLsb);
+    putU16(out + 10, 0);
+    putU32(out + 12, t0Ticks);
+}
+
+// Writes the sample columns after an already written header and returns
+// the total frame size. Timestamps are taken relative to `baseUs`. Samples
+// are read through `sampleAt(i)`, so they need not be contiguous (see
+// capture_window.h). With `carry`, predicted columns continue from and
+// update that state instead of starting afresh. Timestamp deltas are 16-bit
+// (and bound the predicted residuals, see kMaxResidualBytes), so a frame
+// with a gap over UINT16_MAX ticks is refused: it returns 0.
+template <typename SampleAt>
+size_t writeFrameSamplesAt(uint8_t* out, size_t count, const FrameConfig& cfg, uint32_t baseUs,
+                           SampleAt&& sampleAt, TraceState* carry = nullptr) {
+    auto tickAt = [&](size_t i) { return (sampleAt(i).tUs - baseUs) / cfg.tickUs; };
+    auto deltaAt = [&](size_t i) -> uint32_t { return i == 0 ? 0 : tickAt(i) - tickAt(i - 1); };
+    auto leadAt = [&](size_t i) { return toWeightUnits(sampleAt(i).leadGrams, cfg.gramsPerLsb); };
+    auto trailAt = [&](size_t i) { return toWeightUnits(sampleAt(i).trailGrams, cfg.gramsPerLsb); };
+    auto fractionAt = [&](size_t i) {
+        const SwingSample& s = sampleAt(i);
+        return leadFractionQ15(s.leadGrams, s.trailGrams);
+    };
+    auto copXAt = [&](size_t i) { return sampleAt(i).copXMm; };
+    auto copYAt = [&](size_t i) { return sampleAt(i).copYMm; };
+    const bool withFraction = cfg.flags & kFlagLeadFraction;
+    const bool withCop = cfg.flags & kFlagCenterOfPressure;
+    for (size_t i = 1; i < count; i++) {
+        if (deltaAt(i) > UINT16_MAX) return 0;
+    }
+
+    if (cfg.flags & kFlagPredictedVarint) {
+        TraceState fresh;
+        TraceState& state = carry ? *carry : fresh;
+        const uint32_t firstTick = count ? tickAt(0) : state.firstTick;
+        state.ticks.shift(static_cast<int32_t>(firstTick - state.firstTick));
+        state.firstTick = firstTick;
+        uint8_t* p = putPredictedColumn(out + kFrameHeaderSize, count, state.ticks, [&](size_t i) {
+            return static_cast<int32_t>(tickAt(i) - firstTick);
+        });
+        p = putPredictedColumn(p, count, state.lead, leadAt);
+        p = putPredictedColumn(p, count, state.trail, trailAt);
+        if (withFraction) p = putPredictedColumn(p, count, state.fraction, fractionAt);
+        if (withCop) {
+            p = putPredictedColumn(p, count, state.copX, copXAt);
+            p = putPredictedColumn(p, count, state.copY, copYAt);
+        }
+        return static_cast<size_t>(p - out);
+    }
+
+    uint8_t* deltas = out + kFrameHeaderSize;
+    uint8_t* lead = deltas + count * 2;
+    uint8_t* trail = lead + count * 2;
+    uint8_t* fraction = trail + count * 2;
+    uint8_t* copX = fraction + (withFraction ? count * 2 : 0);
+    uint8_t* copY = copX + count * 2;
+    for (size_t i = 0; i < count; i++) {
+        putU16(deltas + i * 2, static_cast<uint16_t>(deltaAt(i)));
+        putU16(lead + i * 2, static_cast<uint16_t>(leadAt(i)));
+        putU16(trail + i * 2, static_cast<uint16_t>(trailAt(i)));
+        if (withFraction) putU16(fraction + i * 2, fractionAt(i));
+        if (withCop) {
+            putU16(copX + i * 2, static_cast<uint16_t>(copXAt(i)));
+            putU16(copY + i * 2, static_cast<uint16_t>(copYAt(i)));
+        }
+    }
+    return swingFrameSize(count, cfg.flags);
+}
+
+inline size_t writeFrameSamples(uint8_t* out, const SwingSample* samples, size_t count,
+                                const FrameConfig& cfg, uint32_t baseUs, TraceState* carry = nullptr) {
+    return writeFrameSamplesAt(out, count, cfg, baseUs, [samples](size_t i) -> const SwingSample& { return samples[i]; },
+                               carry);
+}
+
+// Encodes a finished swing into `out`. Returns the number of bytes written,
+// or 0 if the swing does not fit in `cap`, in a 16-bit sample count or in
+// 16-bit timestamp deltas.
+inline size_t encodeSwingFrame(const SwingSample* samples, size_t count, uint8_t* out, size_t cap,
+                               const FrameConfig& cfg = FrameConfig()) {
+    if (count == 0 || count > UINT16_MAX || cfg.tickUs == 0 || cfg.gramsPerLsb == 0) return 0;
+    if (swingFrameSize(count, cfg.flags) > cap) return 0;
+
+    writeFrameHeader(out, kMsgSwing, cfg.flags, static_cast<uint16_t>(count), cfg, samples[0].tUs / cfg.tickUs);
+    return writeFrameSamples(out, samples, count, cfg, 0);
+}
+
+// Handles the format negotiation write from the page. Returns true if the
+// command was a format request, leaving `format` untouched otherwise.
+inline bool parseFormatCommand(const char* cmd, WireFormat& format) {
+    if (strcmp(cmd, "FMT:BIN") == 0) {
+        format = WireFormat::Binary;
+        return true;
+    }
+    if (strcmp(cmd, "FMT:STREAM") == 0) {
+        format = WireFormat::Stream;
+        return true;
+    }
+    if (strcmp(cmd, "FMT:TEXT") == 0) {
+        format = WireFormat::Text;
+        return true;
+    }
+    return false;
+}
+
+// "CODEC:LPV" switches on the predicted-varint columns, "CODEC:RAW" back
+// to fixed-width ones. Only meaningful once a binary format is negotiated;
+// hand the changed config to the streamer with SwingStreamer::setConfig().
+inline bool parseCodecCommand(const char* cmd, FrameConfig& cfg) {
+    if (strcmp(cmd, "CODEC:LPV") == 0) {
+        cfg.flags |= kFlagPredictedVarint;
+        return true;
+    }
+    if (strcmp(cmd, "CODEC:RAW") == 0) {
+        cfg.flags &= static_cast<uint8_t>(~kFlagPredictedVarint);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace pressurepad
@@ -0,0 +1,103 @@
+#pragma once
+
+// Swing summary computed on the board while samples are captured, so the
+// page can show results as soon as IMPACT_BEEP is followed by the summary
+// message and list views never need the full trace. Every update is O(1)
+// per sample; finishing a swing only encodes the message.
+//
+// Summary layout (little-endian):
+//   0  u8   magic
+//   1  u8   version
+//   2  u8   message type (kMsgSummary)
+//   3  u8   flags
+//   4  u16  peak lead fraction, Q15
+//   6  u16  lead fraction at start, Q15
+//   8  u16  lead fraction at top, Q15
+//   10 u16  lead fraction at impact, Q15
+//   12 i32  peak time minus top time, microseconds
+//   16 i32  peak time minus impact time, microseconds
+//   20 u32  top time since capture start, microseconds
+//   24 u32  impact time since capture start, microseconds
+//   28 u16  sample count
+//   30 u16  reserved
+// Fractions are kLeadFractionNone when the pad was empty at that point;
+// top/impact times are 0xFFFFFFFF when that beep was never marked.
+
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgSummary = 0x05;
+constexpr size_t kSummaryFrameSize = 32;
+
+class SwingMetrics {
+public:
+    // `originUs` is what SwingStreamer::begin() got: the capture start, on
+    // the clock of the samples' tUs. `startUs` is when Start was marked, on
+    // that same clock. In the capture window setup both are window times
+    // (origin 0), when streaming engine times both are engine times.
+    void begin(uint32_t originUs, uint32_t startUs) {
+        *this = SwingMetrics();
+        originUs_ = originUs;
+        startUs_ = startUs - originUs;
+    }
+
+    // Beep times, on the samples' clock like begin(). They may be set while
+    // the swing is still being sampled.
+    void markTop(uint32_t tUs) { topUs_ = tUs - originUs_; }
+    void markImpact(uint32_t tUs) { impactUs_ = tUs - originUs_; }
+
+    void add(const SwingSample& s) {
+        uint16_t fraction = leadFractionQ15(s.leadGrams, s.trailGrams);
+        count_++;
+        if (fraction == kLeadFractionNone) return;
+        const uint32_t tUs = s.tUs - originUs_;
+        if (peak_ == kLeadFractionNone || fraction > peak_) {
+            peak_ = fraction;
+            peakUs_ = tUs;
+        }
+        latch(atStart_, startUs_, tUs, fraction);
+        latch(atTop_, topUs_, tUs, fraction);
+        latch(atImpact_, impactUs_, tUs, fraction);
+    }
+
+    size_t encode(uint8_t* out, size_t cap) const {
+        if (cap < kSummaryFrameSize) return 0;
+        out[0] = kFrameMagic;
+        out[1] = kFrameVersion;
+        out[2] = kMsgSummary;
+        out[3] = 0;
+        putU16(out + 4, peak_);
+        putU16(out + 6, atStart_);
+        putU16(out + 8, atTop_);
+        putU16(out + 10, atImpact_);
+        putU32(out + 12, static_cast<uint32_t>(static_cast<int32_t>(peakUs_ - topUs_)));
+        putU32(out + 16, static_cast<uint32_t>(static_cast<int32_t>(peakUs_ - impactUs_)));
+        putU32(out + 20, topUs_);
+        putU32(out + 24, impactUs_);
+        putU16(out + 28, static_cast<uint16_t>(count_ > UINT16_MAX ? UINT16_MAX : count_));
+        putU16(out + 30, 0);
+        return kSummaryFrameSize;
+    }
+
+private:
+    static constexpr uint32_t kUnset = UINT32_MAX;
+
+    // Takes the first sample at or after `markUs`.
+    static void latch(uint16_t& slot, uint32_t markUs, uint32_t tUs, uint16_t fraction) {
+        if (slot == kLeadFractionNone && markUs != kUnset && tUs >= markUs) slot = fraction;
+    }
+
+    uint32_t originUs_ = 0;
+    uint32_t startUs_ = 0;  // this and the marks are relative to originUs_
+    uint32_t topUs_ = kUnset;
+    uint32_t impactUs_ = kUnset;
+    uint32_t peakUs_ = 0;
+    uint16_t peak_ = kLeadFractionNone;
+    uint16_t atStart_ = kLeadFractionNone;
+    uint16_t atTop_ = kLeadFractionNone;
+    uint16_t atImpact_ = kLeadFractionNone;
+    size_t count_ = 0;
+};
+
+}  // namespace pressurepad
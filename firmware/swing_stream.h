@@ -0,0 +1,118 @@
+#pragma once
+
+// Streaming mode, negotiated with "FMT:STREAM". Instead of one frame after
+// IMPACT_BEEP, samples are sent during the swing in small chunks that reuse
+// the swing frame header (type kMsgChunk, reserved field = sequence number,
+// first timestamp relative to swing start). A kMsgSwingEnd header with the
+// total sample count and no payload closes the swing on the page; its
+// sequence field is the number of chunks and its timestamp field carries
+// the board's swing sequence number (see swing_transfer.h).
+//
+// With the predicted-varint codec every chunk but a keyframe continues the
+// previous chunk's predictors (kFlagCarriedPredictor, see trace_codec.h),
+// so a column costs about a byte per sample instead of restarting every
+// few samples. Chunk 0 and every kKeyframeChunks-th chunk after it restart
+// them, which bounds what a lost chunk takes with it: a decoder that missed
+// one drops the carried chunks up to the next keyframe. A chunk after a gap
+// too long for a 16-bit delta is a keyframe as well.
+
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgChunk = 0x02;
+constexpr uint8_t kMsgSwingEnd = 0x03;
+constexpr uint16_t kKeyframeChunks = 16;
+
+// Batches samples and hands each encoded chunk to `send(const uint8_t*, size_t)`,
+// typically a wrapper around setValue()/notify(). BatchSize is kept small so
+// a chunk stays well under common negotiated MTUs and per-chunk latency is
+// bounded to BatchSize sample periods.
+template <size_t BatchSize = 6>
+class SwingStreamer {
+public:
+    // Worst case over every column set the config may switch on.
+    static constexpr size_t kChunkBytes =
+        kFrameHeaderSize + BatchSize * sampleBytes(kFlagLeadFraction | kFlagPredictedVarint | kFlagCenterOfPressure);
+
+    explicit SwingStreamer(const FrameConfig& cfg = FrameConfig()) : cfg_(cfg), nextCfg_(cfg) {}
+
+    // Call after every command that changes the frame config ("CODEC:",
+    // "COP:"). Takes effect at the next begin(), so the chunks of one swing
+    // never mix codecs or column sets.
+    void setConfig(const FrameConfig& cfg) { nextCfg_ = cfg; }
+
+    // Caps samples per chunk below BatchSize, e.g. to what fits in one
+    // notification at the negotiated MTU.
+    void setBatchLimit(size_t limit) {
+        limit_ = limit == 0 ? 1 : (limit > BatchSize ? BatchSize : limit);
+    }
+
+    void begin(uint32_t startUs, uint16_t swingSeq = 0) {
+        cfg_ = nextCfg_;
+        startUs_ = startUs;
+        swingSeq_ = swingSeq;
+        seq_ = 0;
+        pending_ = 0;
+        total_ = 0;
+        keyframe_ = false;
+    }
+
+    // A gap too long for a 16-bit delta closes the chunk first; the next
+    // one is a keyframe with its own first timestamp.
+    template <typename Send>
+    void push(const SwingSample& sample, Send&& send) {
+        const bool gap = total_ > 0 && tickOf(sample) - lastTick_ > UINT16_MAX;
+        if (gap) flush(send);
+        keyframe_ |= gap;
+        lastTick_ = tickOf(sample);
+        batch_[pending_++] = sample;
+        total_++;
+        if (pending_ >= limit_) flush(send);
+    }
+
+    template <typename Send>
+    void flush(Send&& send) {
+        if (pending_ == 0) return;
+        uint8_t out[kChunkBytes];
+        uint32_t firstTick = tickOf(batch_[0]);
+        const bool carried = (cfg_.flags & kFlagPredictedVarint) && seq_ % kKeyframeChunks != 0 && !keyframe_;
+        keyframe_ = false;
+        if (!carried) trace_ = TraceState();
+        writeFrameHeader(out, kMsgChunk, static_cast<uint8_t>(cfg_.flags | (carried ? kFlagCarriedPredictor : 0)),
+                         static_cast<uint16_t>(pending_), cfg_, firstTick);
+        putU16(out + 10, seq_++);
+
+        size_t size = writeFrameSamples(out, batch_, pending_, cfg_, startUs_, &trace_);
+        send(out, size);
+        pending_ = 0;
+    }
+
+    template <typename Send>
+    void end(Send&& send) {
+        flush(send);
+        uint8_t out[kFrameHeaderSize];
+        writeFrameHeader(out, kMsgSwingEnd, 0, static_cast<uint16_t>(total_ > UINT16_MAX ? UINT16_MAX : total_),
+                         cfg_, swingSeq_);
+        putU16(out + 10, seq_);
+        send(out, kFrameHeaderSize);
+    }
+
+private:
+    uint32_t tickOf(const SwingSample& s) const { return (s.tUs - startUs_) / cfg_.tickUs; }
+
+    FrameConfig cfg_;
+    FrameConfig nextCfg_;
+    TraceState trace_;
+    SwingSample batch_[BatchSize];
+    uint32_t startUs_ = 0;
+    uint32_t lastTick_ = 0;
+    uint16_t seq_ = 0;
+    uint16_t swingSeq_ = 0;
+    size_t pending_ = 0;
+    size_t total_ = 0;
+    size_t limit_ = BatchSize;
+    bool keyframe_ = false;
+};
+
+}  // namespace pressurepad
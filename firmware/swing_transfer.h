@@ -0,0 +1,150 @@
+#pragma once
+
+// Resumable swing transfer. Every stream chunk and the closing kMsgSwingEnd
+// of the newest swing are kept, encoded, in a fixed buffer until the page
+// acknowledges the whole swing, so a link that drops mid-upload loses
+// nothing: after reconnecting the page asks what is held and continues from
+// the first chunk it is missing.
+//
+//   page -> board  "RESUME?"               board answers with kMsgResume
+//   page -> board  "RESUME:<swing>:<chunk>" resend from that chunk on
+//   page -> board  "ACK:<swing>"           swing received, drop it
+//
+// Resume reply: a frame header with type kMsgResume, count = frames held
+// (chunks plus the end frame once the swing is complete), sequence field =
+// kResumeComplete and/or kResumeOverflowed, and t0 = swing sequence number;
+// count 0 means nothing held. An overflowed swing is held only up to the
+// first frame that did not fit, end frame included, so the page stops
+// resuming past `count` and finishes the swing with its gap count.
+// Swing sequence numbers increase by one per swing and are also sent in
+// each kMsgSwingEnd (see swing_stream.h).
+//
+//   SwingTransfer<> transfer;
+//   START_SWING:  streamer.begin(startUs, transfer.begin()); metrics.begin(startUs, startUs);
+//   sending:      auto send = [&](const uint8_t* p, size_t n) { transfer.record(p, n); notify(p, n); };
+//   on a write:   transfer.handleCommand(cmd, notify);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swing_frame.h"
+#include "swing_stream.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgResume = 0x08;
+constexpr uint16_t kResumeComplete = 0x0001;
+constexpr uint16_t kResumeOverflowed = 0x0002;
+
+template <size_t Bytes = 32768, size_t MaxFrames = 1024>
+class SwingTransfer {
+    static_assert(Bytes <= UINT16_MAX + 1, "frame offsets are 16-bit");
+
+public:
+    static constexpr size_t kBytes = Bytes;
+
+    // Starts holding a new swing, dropping any unacknowledged one, and
+    // returns its sequence number.
+    uint16_t begin() {
+        swingSeq_ = nextSwingSeq_++;
+        if (nextSwingSeq_ == 0) nextSwingSeq_ = 1;  // 0 is "no sequence", as on older boards
+        used_ = 0;
+        frames_ = 0;
+        complete_ = false;
+        overflowed_ = false;
+        held_ = true;
+        return swingSeq_;
+    }
+
+    // Keeps a copy of a frame of the current swing, in send order. Only
+    // stream chunks and the end frame are held, so frame i is chunk i.
+    void record(const uint8_t* frame, size_t size) {
+        if (!held_ || overflowed_ || complete_ || size < kFrameHeaderSize) return;
+        if (frame[2] != kMsgChunk && frame[2] != kMsgSwingEnd) return;
+        if (frames_ == MaxFrames || used_ + size > Bytes) {
+            // Chunks past this point cannot be resumed; the page falls back
+            // to its gap count, as without resume.
+            overflowed_ = true;
+            return;
+        }
+        memcpy(bytes_ + used_, frame, size);
+        offsets_[frames_++] = static_cast<uint16_t>(used_);
+        used_ += size;
+        if (frame[2] == kMsgSwingEnd) complete_ = true;
+    }
+
+    void ack(uint16_t swingSeq) {
+        if (held_ && swingSeq == swingSeq_) held_ = false;
+    }
+
+    bool holding() const { return held_; }
+    uint16_t swingSeq() const { return swingSeq_; }
+
+    size_t encodeResumeReply(uint8_t* out, size_t cap) const {
+        if (cap < kFrameHeaderSize) return 0;
+        FrameConfig cfg;
+        writeFrameHeader(out, kMsgResume, 0, static_cast<uint16_t>(held_ ? frames_ : 0), cfg, held_ ? swingSeq_ : 0);
+        uint16_t state = 0;
+        if (held_ && complete_) state |= kResumeComplete;
+        if (held_ && overflowed_) state |= kResumeOverflowed;
+        putU16(out + 10, state);
+        return kFrameHeaderSize;
+    }
+
+    // Resends the held frames from chunk `fromChunk` on through
+    // `send(const uint8_t*, size_t)`. Returns false if that swing is not
+    // held (acknowledged, replaced or never recorded that far).
+    template <typename Send>
+    bool resend(uint16_t swingSeq, uint16_t fromChunk, Send&& send) const {
+        if (!held_ || swingSeq != swingSeq_ || fromChunk > frames_) return false;
+        for (size_t i = fromChunk; i < frames_; i++) {
+            const size_t end = i + 1 < frames_ ? offsets_[i + 1] : used_;
+            send(bytes_ + offsets_[i], end - offsets_[i]);
+        }
+        return true;
+    }
+
+    // Handles "RESUME?", "RESUME:<swing>:<chunk>" and "ACK:<swing>"; returns
+    // false for anything else so the caller can fall through.
+    template <typename Send>
+    bool handleCommand(const char* cmd, Send&& send) {
+        if (strcmp(cmd, "RESUME?") == 0) {
+            uint8_t reply[kFrameHeaderSize];
+            send(reply, encodeResumeReply(reply, sizeof reply));
+            return true;
+        }
+        char* end = nullptr;
+        if (strncmp(cmd, "ACK:", 4) == 0) {
+            unsigned long seq = strtoul(cmd + 4, &end, 10);
+            if (end == cmd + 4 || *end != '\0') return false;
+            ack(static_cast<uint16_t>(seq));
+            return true;
+        }
+        if (strncmp(cmd, "RESUME:", 7) != 0) return false;
+        unsigned long seq = strtoul(cmd + 7, &end, 10);
+        if (end == cmd + 7 || *end != ':') return false;
+        const char* chunkAt = end + 1;
+        unsigned long chunk = strtoul(chunkAt, &end, 10);
+        if (end == chunkAt || *end != '\0') return false;
+        if (!resend(static_cast<uint16_t>(seq), static_cast<uint16_t>(chunk > UINT16_MAX ? UINT16_MAX : chunk), send)) {
+            uint8_t reply[kFrameHeaderSize];
+            send(reply, encodeResumeReply(reply, sizeof reply));
+        }
+        return true;
+    }
+
+private:
+    uint8_t bytes_[Bytes];
+    uint16_t offsets_[MaxFrames];
+    size_t used_ = 0;
+    size_t frames_ = 0;
+    uint16_t nextSwingSeq_ = 1;
+    uint16_t swingSeq_ = 0;
+    bool held_ = false;
+    bool complete_ = false;
+    bool overflowed_ = false;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,221 @@
+#pragma once
+
+// Tempo engine. A tempo is any "<back>/<down>" pair of 1/30 s frames within
+// [kMinTempoFrames, kMaxTempoFrames]; the presets are only what the page
+// shows as buttons, sent in the tempo capability message after the config
+// reply to "CFG?".
+//
+// Beeps are scheduled from the START_SWING sample time as absolute
+// deadlines, frames * 1 s / 30 from start, so neither the truncated
+// kTempoFrameUs nor timer wake-up latency accumulates from top to impact.
+// poll() runs once per captured sample and fires on the first sample at or
+// after the deadline, so a beep's reported time is always a sample time.
+//
+// Capability layout:
+//   0  u8   magic
+//   1  u8   version
+//   2  u8   message type (kMsgTempos)
+//   3  u8   preset count
+//   4  u8   fewest frames in either phase
+//   5  u8   most frames in either phase
+//   6  u8   back, u8 down per preset
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_channel.h"
+#include "swing_frame.h"
+
+namespace pressurepad {
+
+constexpr uint8_t kMsgTempos = 0x07;
+constexpr uint8_t kMinTempoFrames = 2;
+constexpr uint8_t kMaxTempoFrames = 60;
+constexpr uint32_t kTempoFramesPerSecond = 30;
+
+struct Tempo {
+    uint8_t backFrames;
+    uint8_t downFrames;
+};
+
+constexpr bool validTempo(Tempo t) {
+    return t.backFrames >= kMinTempoFrames && t.backFrames <= kMaxTempoFrames && t.downFrames >= kMinTempoFrames &&
+           t.downFrames <= kMaxTempoFrames;
+}
+
+// Full swing at 3:1 and short game at 2:1.
+constexpr Tempo kTempoPresets[] = {
+    {18, 6}, {21, 7}, {24, 8}, {27, 9}, {30, 10}, {14, 7}, {16, 8}, {18, 9},
+};
+constexpr size_t kTempoPresetCount = sizeof(kTempoPresets) / sizeof(kTempoPresets[0]);
+constexpr size_t kTemposFrameSize = 6 + 2 * kTempoPresetCount;
+
+constexpr bool validPresets() {
+    for (size_t i = 0; i < kTempoPresetCount; i++) {
+        if (!validTempo(kTempoPresets[i])) return false;
+    }
+    return true;
+}
+static_assert(validPresets(), "every tempo preset must be a valid tempo");
+static_assert(kTempoPresetCount <= UINT8_MAX, "preset count is one byte on the wire");
+
+inline size_t encodeTemposFrame(uint8_t* out, size_t cap) {
+    if (cap < kTemposFrameSize) return 0;
+    out[0] = kFrameMagic;
+    out[1] = kFrameVersion;
+    out[2] = kMsgTempos;
+    out[3] = static_cast<uint8_t>(kTempoPresetCount);
+    out[4] = kMinTempoFrames;
+    out[5] = kMaxTempoFrames;
+    for (size_t i = 0; i < kTempoPresetCount; i++) {
+        out[6 + 2 * i] = kTempoPresets[i].backFrames;
+        out[7 + 2 * i] = kTempoPresets[i].downFrames;
+    }
+    return kTemposFrameSize;
+}
+
+// Parses "<back>/<down>". Returns false, leaving `tempo` untouched, for
+// anything else or for a pair outside the frame limits.
+inline bool parseTempoCommand(const char* cmd, Tempo& tempo) {
+    char* end = nullptr;
+    long back = strtol(cmd, &end, 10);
+    if (end == cmd || *end != '/') return false;
+    const char* downAt = end + 1;
+    long down = strtol(downAt, &end, 10);
+    if (end == downAt || *end != '\0' || back < 0 || down < 0 || back > UINT8_MAX || down > UINT8_MAX) return false;
+    const Tempo parsed = {static_cast<uint8_t>(back), static_cast<uint8_t>(down)};
+    if (!validTempo(parsed)) return false;
+    tempo = parsed;
+    return true;
+}
+
+// Exact frame boundary, rounded to the microsecond.
+constexpr uint32_t tempoFramesUs(uint32_t frames) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(frames) * 1000000 + kTempoFramesPerSecond / 2) /
+                                 kTempoFramesPerSecond);
+}
+
+class TempoEngine {
+public:
+    void setTempo(Tempo tempo) { tempo_ = tempo; }
+    Tempo tempo() const { return tempo_; }
+    bool active() const { return next_ != Next::None; }
+
+    // Capture-clock time of START_SWING, normally the sample that started it.
+    void begin(uint32_t startUs) {
+        topUs_ = startUs + tempoFramesUs(tempo_.backFrames);
+        impactUs_ = startUs + tempoFramesUs(tempo_.backFrames + tempo_.downFrames);
+        next_ = Next::Top;
+    }
+
+    void cancel() { next_ = Next::None; }
+
+    // Beep deadlines on the capture clock, valid after begin().
+    uint32_t topUs() const { return topUs_; }
+    uint32_t impactUs() const { return impactUs_; }
+
+    // Sampling context: calls onBeep(EventCode, sampleUs) for each beep due
+    // at this sample. A late sample fires both beeps in order.
+    template <typename OnBeep>
+    void poll(uint32_t sampleUs, OnBeep&& onBeep) {
+        if (next_ == Next::Top && due(sampleUs, topUs_)) {
+            next_ = Next::Impact;
+            onBeep(EventCode::TopBeep, sampleUs);
+        }
+        if (next_ == Next::Impact && due(sampleUs, impactUs_)) {
+            next_ = Next::None;
+            onBeep(EventCode::ImpactBeep, sampleUs);
+        }
+    }
+
+private:
+    enum class Next : uint8_t { None, Top, Impact };
+
+    static bool due(uint32_t nowUs, uint32_t deadlineUs) { return static_cast<int32_t>(nowUs - deadlineUs) >= 0; }
+
+    Tempo tempo_ = kTempoPresets[0];
+    uint32_t topUs_ = 0;
+    uint32_t impactUs_ = 0;
+    Next next_ = Next::None;
+};
+
+}  // namespace pressurepad
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+namespace pressurepad {
+
+// Drives the buzzer from a one-shot esp_timer armed at the engine's
+// absolute deadlines, so the audible beep does not wait for the next
+// sample. Every alarm is computed from a deadline, not from when the
+// previous alarm ran, which keeps timer latency from adding up. The events
+// that go to the page still come from TempoEngine::poll() on the sample
+// clock. Call arm() once, right after TempoEngine::begin().
+class Esp32BeepTimer {
+public:
+    bool begin(int buzzerPin, uint32_t toneHz = 2000, uint32_t beepMs = 60) {
+        pin_ = buzzerPin;
+        toneHz_ = toneHz;
+        beepUs_ = beepMs * 1000;
+        esp_timer_create_args_t args = {};
+        args.callback = onTimer;
+        args.arg = this;
+        args.name = "tempo";
+        return esp_timer_create(&args, &timer_) == ESP_OK;
+    }
+
+    // `captureStartUs` is the esp_timer time of capture-clock 0.
+    void arm(const TempoEngine& engine, int64_t captureStartUs) {
+        cancel();
+        if (!engine.active()) return;
+        deadlines_[0] = captureStartUs + engine.topUs();
+        deadlines_[1] = captureStartUs + engine.impactUs();
+        step_ = 0;
+        startAt(deadlines_[0]);
+    }
+
+    void cancel() {
+        esp_timer_stop(timer_);
+        if (step_ % 2 == 1) noTone(pin_);
+        step_ = kDone;
+    }
+
+private:
+    static constexpr uint8_t kDone = 4;
+
+    void startAt(int64_t atUs) {
+        const int64_t wait = atUs - esp_timer_get_time();
+        esp_timer_start_once(timer_, wait > 0 ? static_cast<uint64_t>(wait) : 1);
+    }
+
+    // Steps: 0 top on, 1 top off, 2 impact on, 3 impact off.
+    static void onTimer(void* arg) {
+        auto* self = static_cast<Esp32BeepTimer*>(arg);
+        const uint8_t step = self->step_;
+        if (step >= kDone) return;
+        self->step_ = step + 1;
+        if (step % 2 == 0) {
+            tone(self->pin_, self->toneHz_);
+            self->startAt(self->deadlines_[step / 2] + self->beepUs_);
+        } else {
+            noTone(self->pin_);
+            if (step == 1) self->startAt(self->deadlines_[1]);
+        }
+    }
+
+    esp_timer_handle_t timer_ = nullptr;
+    int pin_ = -1;
+    uint32_t toneHz_ = 2000;
+    uint32_t beepUs_ = 60000;
+    int64_t deadlines_[2] = {0, 0};
+    volatile uint8_t step_ = kDone;
+};
+
+}  // namespace pressurepad
+
+#endif  // ARDUINO_ARCH_ESP32
@@ -0,0 +1,96 @@
+#pragma once
+
+// Trace codec for frames with kFlagPredictedVarint. Each column (relative
+// ticks, lead, trail, lead fraction, center of pressure) is written as
+// zigzag varints of the residual against a linear predictor: 0 for the
+// first value, the previous value for the second, 2*x[n-1] - x[n-2] after
+// that. Weight curves and a steady sample clock are close to linear, so
+// most residuals fit in one byte.
+//
+// Stream chunks hold only a few samples, so restarting the predictor in
+// every chunk would spend most of the bytes on the first two values of each
+// column. A chunk with kFlagCarriedPredictor instead continues from the
+// previous chunk's last two values (TraceState); see swing_stream.h for
+// when the streamer restarts it.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pressurepad {
+
+inline uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline uint8_t* putVarint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(v);
+    return p;
+}
+
+class LinearPredictor {
+public:
+    int32_t predict() const {
+        if (n_ == 0) return 0;
+        if (n_ == 1) return prev_;
+        return 2 * prev_ - prev2_;
+    }
+
+    void push(int32_t v) {
+        prev2_ = prev_;
+        prev_ = v;
+        if (n_ < 2) n_++;
+    }
+
+    // Moves the values seen so far onto a new origin, e.g. from one chunk's
+    // first tick to the next one's. The prediction moves with them.
+    void shift(int32_t by) {
+        prev_ -= by;
+        prev2_ -= by;
+    }
+
+private:
+    int32_t prev_ = 0;
+    int32_t prev2_ = 0;
+    uint8_t n_ = 0;
+};
+
+// Every column holds 16-bit quantities (weights, Q15 fractions, tick deltas
+// of at most UINT16_MAX, see writeFrameSamplesAt()), so a residual stays
+// within +/-3 * 65535 and its zigzag varint never exceeds three bytes.
+constexpr size_t kMaxResidualBytes = 3;
+
+// Predictor state of every column between the chunks of one swing. Tick
+// values are kept relative to the first tick of the chunk they came from.
+struct TraceState {
+    LinearPredictor ticks;
+    LinearPredictor lead;
+    LinearPredictor trail;
+    LinearPredictor fraction;
+    LinearPredictor copX;
+    LinearPredictor copY;
+    uint32_t firstTick = 0;
+};
+
+// Writes one column, reading values through `valueAt(i)` and continuing
+// from `predictor`. Returns the end of the written bytes.
+template <typename ValueAt>
+uint8_t* putPredictedColumn(uint8_t* p, size_t count, LinearPredictor& predictor, ValueAt&& valueAt) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = valueAt(i);
+        p = putVarint(p, zigzag(v - predictor.predict()));
+        predictor.push(v);
+    }
+    return p;
+}
+
+template <typename ValueAt>
+uint8_t* putPredictedColumn(uint8_t* p, size_t count, ValueAt&& valueAt) {
+    LinearPredictor predictor;
+    return putPredictedColumn(p, count, predictor, valueAt);
+}
+
+}  // namespace pressurepad
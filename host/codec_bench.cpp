@@ -0,0 +1,193 @@
+// Microbenchmark for the firmware wire codec, the host-side counterpart of
+// the page's ?bench mode. Encodes synthetic swings as fixed-width and
+// predicted-varint kMsgSwing frames, streams them as kMsgChunk frames and
+// decodes both frame kinds again, then reports p50/p99 per stage and the
+// wire size per sample. A decode that does not reproduce the encoded
+// samples fails the run, and so does a stream that SwingAssembler does not
+// rebuild, so format changes are checked as well as timed.
+//
+//   g++ -std=c++17 -O2 host/codec_bench.cpp -o codec_bench
+//   ./codec_bench [--swings 200] [--rate 1000] [--seconds 3]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../firmware/swing_stream.h"
+#include "frame_decoder.h"
+#include "swing_assembler.h"
+
+using namespace pressurepad;
+
+namespace {
+
+constexpr int32_t kTotalGrams = 80000;
+
+struct Stage {
+    explicit Stage(const char* stageName) : name(stageName) {}
+
+    std::string name;
+    std::vector<double> us;
+    size_t bytes = 0;
+    size_t samples = 0;
+};
+
+// Stance, weight shift to the trail foot and back through impact, with a
+// few grams of deterministic noise so the predictor has residuals to code.
+std::vector<SwingSample> syntheticSwing(uint32_t rateHz, double seconds, uint32_t seed) {
+    const size_t count = std::min<size_t>(UINT16_MAX, std::max<size_t>(2, static_cast<size_t>(rateHz * seconds)));
+    std::vector<SwingSample> samples(count);
+    uint32_t noise = (seed + 1) * 2654435761u;
+    for (size_t i = 0; i < count; i++) {
+        noise = noise * 1664525u + 1013904223u;
+        const double t = static_cast<double>(i) / rateHz;
+        const double share = 0.5 - 0.25 * std::sin(2 * M_PI * t / seconds) + (noise / 4294967296.0 - 0.5) * 0.02;
+        SwingSample& s = samples[i];
+        s.tUs = static_cast<uint32_t>(i * 1000000ull / rateHz);
+        s.leadGrams = static_cast<int32_t>(std::lround(kTotalGrams * share));
+        s.trailGrams = kTotalGrams - s.leadGrams;
+    }
+    return samples;
+}
+
+template <typename Run>
+void timeStage(Stage& stage, Run&& run) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const auto stop = std::chrono::steady_clock::now();
+    stage.us.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+// The wire keeps grams in gramsPerLsb units and times in ticks.
+bool sameSamples(const std::vector<SwingSample>& a, const std::vector<SwingSample>& b, const FrameConfig& cfg) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (b[i].tUs != a[i].tUs / cfg.tickUs * cfg.tickUs) return false;
+        if (b[i].leadGrams != toWeightUnits(a[i].leadGrams, cfg.gramsPerLsb) * cfg.gramsPerLsb) return false;
+        if (b[i].trailGrams != toWeightUnits(a[i].trailGrams, cfg.gramsPerLsb) * cfg.gramsPerLsb) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int swings = 200;
+    uint32_t rateHz = 1000;
+    double seconds = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--swings") == 0) {
+            swings = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--rate") == 0) {
+            rateHz = static_cast<uint32_t>(atoi(argv[i + 1]));
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "usage: %s [--swings N] [--rate HZ] [--seconds S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (swings <= 0 || rateHz == 0 || !(seconds > 0)) {
+        fprintf(stderr, "swings, rate and seconds must be positive\n");
+        return 2;
+    }
+
+    FrameConfig raw;
+    FrameConfig lpv;
+    lpv.flags |= kFlagPredictedVarint;
+
+    Stage encodeRaw{"encode fixed-width"};
+    Stage encodeLpv{"encode predicted-varint"};
+    Stage stream{"stream chunks (varint)"};
+    Stage decodeRaw{"decode fixed-width"};
+    Stage decodeLpv{"decode predicted-varint"};
+
+    size_t count = 0;
+    for (int n = 0; n < swings; n++) {
+        const std::vector<SwingSample> samples = syntheticSwing(rateHz, seconds, static_cast<uint32_t>(n));
+        count = samples.size();
+        std::vector<uint8_t> rawFrame(swingFrameSize(count, raw.flags));
+        std::vector<uint8_t> lpvFrame(swingFrameSize(count, lpv.flags));
+        size_t rawSize = 0;
+        size_t lpvSize = 0;
+
+        timeStage(encodeRaw, [&] { rawSize = encodeSwingFrame(samples.data(), count, rawFrame.data(), rawFrame.size(), raw); });
+        timeStage(encodeLpv, [&] { lpvSize = encodeSwingFrame(samples.data(), count, lpvFrame.data(), lpvFrame.size(), lpv); });
+        if (rawSize == 0 || lpvSize == 0) {
+            fprintf(stderr, "swing of %zu samples did not encode\n", count);
+            return 1;
+        }
+
+        SwingStreamer<> streamer(lpv);
+        size_t streamed = 0;
+        timeStage(stream, [&] {
+            auto send = [&](const uint8_t*, size_t size) { streamed += size; };
+            streamer.begin(0);
+            for (const SwingSample& s : samples) streamer.push(s, send);
+            streamer.end(send);
+        });
+
+        std::vector<SwingSample> decoded(count);
+        FrameHeader header;
+        bool ok = false;
+        {
+            SwingAssembler assembler;
+            AssembledSwing swing;
+            auto send = [&](const uint8_t* p, size_t size) { ok = assembler.feed(p, size, swing) || ok; };
+            streamer.begin(0);
+            for (const SwingSample& s : samples) streamer.push(s, send);
+            streamer.end(send);
+            ok = ok && swing.samples == count && swing.missedChunks == 0 &&
+                 readFrameHeader(swing.frame.data(), swing.frame.size(), header) &&
+                 decodeFrameSamples(swing.frame.data(), swing.frame.size(), header, decoded.data());
+        }
+        if (!ok || !sameSamples(samples, decoded, lpv)) {
+            fprintf(stderr, "stream of swing %d did not reassemble\n", n);
+            return 1;
+        }
+        timeStage(decodeRaw, [&] {
+            ok = readFrameHeader(rawFrame.data(), rawSize, header) &&
+                 decodeFrameSamples(rawFrame.data(), rawSize, header, decoded.data());
+        });
+        if (!ok || !sameSamples(samples, decoded, raw)) {
+            fprintf(stderr, "fixed-width frame of swing %d did not round-trip\n", n);
+            return 1;
+        }
+        timeStage(decodeLpv, [&] {
+            ok = readFrameHeader(lpvFrame.data(), lpvSize, header) &&
+                 decodeFrameSamples(lpvFrame.data(), lpvSize, header, decoded.data());
+        });
+        if (!ok || !sameSamples(samples, decoded, lpv)) {
+            fprintf(stderr, "predicted-varint frame of swing %d did not round-trip\n", n);
+            return 1;
+        }
+
+        for (Stage* stage : {&encodeRaw, &decodeRaw}) stage->bytes += rawSize;
+        for (Stage* stage : {&encodeLpv, &decodeLpv}) stage->bytes += lpvSize;
+        stream.bytes += streamed;
+        for (Stage* stage : {&encodeRaw, &encodeLpv, &stream, &decodeRaw, &decodeLpv}) stage->samples += count;
+    }
+
+    printf("%d swings, %zu samples each (%u Hz x %g s)\n", swings, count, rateHz, seconds);
+    printf("%-26s %9s %9s %9s %9s %9s %12s\n", "stage", "p50 us", "p99 us", "mean us", "max us", "ns/sample", "bytes/sample");
+    for (Stage* stage : {&encodeRaw, &encodeLpv, &stream, &decodeRaw, &decodeLpv}) {
+        std::vector<double>& us = stage->us;
+        std::sort(us.begin(), us.end());
+        double total = 0;
+        for (double v : us) total += v;
+        printf("%-26s %9.1f %9.1f %9.1f %9.1f %9.1f %12.2f\n", stage->name.c_str(), percentile(us, 0.5),
+               percentile(us, 0.99), total / us.size(), us.back(), total * 1000 / stage->samples,
+               static_cast<double>(stage->bytes) / stage->samples);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// Single-threaded epoll loop for the ingest daemon. Sockets are registered
+// with a handler; other threads (the BLE backend's callbacks) hand work to
+// the loop with post(), which wakes it through an eventfd. Linux only.
+
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pressurepad {
+
+class EventLoop {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+
+    EventLoop() : epoll_(epoll_create1(EPOLL_CLOEXEC)), wake_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        add(wake_, EPOLLIN, [this](uint32_t) { drainPosted(); });
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    ~EventLoop() {
+        ::close(wake_);
+        ::close(epoll_);
+    }
+
+    bool valid() const { return epoll_ >= 0 && wake_ >= 0; }
+
+    bool add(int fd, uint32_t events, Handler handler) {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev) != 0) return false;
+        handlers_[fd] = std::move(handler);
+        return true;
+    }
+
+    bool modify(int fd, uint32_t events) {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.fd = fd;
+        return epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &ev) == 0;
+    }
+
+    // Safe to call from inside the fd's own handler.
+    void remove(int fd) {
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+        handlers_.erase(fd);
+    }
+
+    // Thread-safe: runs `task` on the loop thread.
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            posted_.push_back(std::move(task));
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_, &one, sizeof one);
+        (void)ignored;
+    }
+
+    void stop() { running_ = false; }
+
+    void run() {
+        running_ = true;
+        epoll_event events[64];
+        while (running_) {
+            int n = epoll_wait(epoll_, events, 64, -1);
+            for (int i = 0; i < n && running_; i++) {
+                auto it = handlers_.find(events[i].data.fd);
+                if (it == handlers_.end()) continue;
+                Handler handler = it->second;  // the handler may remove itself
+                handler(events[i].events);
+            }
+        }
+    }
+
+private:
+    void drainPosted() {
+        uint64_t count;
+        ssize_t ignored = read(wake_, &count, sizeof count);
+        (void)ignored;
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks.swap(posted_);
+        }
+        for (auto& task : tasks) task();
+    }
+
+    int epoll_;
+    int wake_;
+    bool running_ = false;
+    std::unordered_map<int, Handler> handlers_;
+    std::mutex mutex_;
+    std::vector<std::function<void()>> posted_;
+};
+
+}  // namespace pressurepad
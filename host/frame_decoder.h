@@ -0,0 +1,136 @@
+#pragma once
+
+// Host-side reader for the wire frames in swing_frame.h and
+// swing_stream.h: the header, and both the fixed-width and the
+// predicted-varint sample columns. Mirrors decodeFrameSamples() in the
+// page's ingest worker.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../firmware/swing_frame.h"
+
+namespace pressurepad {
+
+inline uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return getU16(p) | (static_cast<uint32_t>(getU16(p + 2)) << 16);
+}
+
+struct FrameHeader {
+    uint8_t type = 0;
+    uint8_t flags = 0;
+    uint16_t count = 0;
+    uint16_t tickUs = 0;
+    uint16_t gramsPerLsb = 0;
+    uint16_t reserved = 0;  // sequence number on kMsgChunk
+    uint32_t t0Ticks = 0;
+};
+
+inline bool isBinaryFrame(const uint8_t* data, size_t size) {
+    return size >= 4 && data[0] == kFrameMagic;
+}
+
+inline bool readFrameHeader(const uint8_t* data, size_t size, FrameHeader& h) {
+    if (size < kFrameHeaderSize || data[0] != kFrameMagic || data[1] != kFrameVersion) return false;
+    h.type = data[2];
+    h.flags = data[3];
+    h.count = getU16(data + 4);
+    h.tickUs = getU16(data + 6);
+    h.gramsPerLsb = getU16(data + 8);
+    h.reserved = getU16(data + 10);
+    h.t0Ticks = getU32(data + 12);
+    return true;
+}
+
+// Reads one predicted-varint column, continuing from `predictor`. Returns
+// the offset after it, or 0 if the frame is truncated.
+template <typename Store>
+size_t readPredictedColumn(const uint8_t* data, size_t size, size_t offset, size_t count, LinearPredictor& predictor,
+                           Store&& store) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            if (offset >= size || shift > 28) return 0;
+            byte = data[offset++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        int32_t residual = static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+        int32_t current = predictor.predict() + residual;
+        store(i, current);
+        predictor.push(current);
+    }
+    return offset;
+}
+
+// Decodes the samples of a kMsgSwing or kMsgChunk frame into `out`, which
+// must hold h.count entries. The lead fraction column is skipped, it is
+// derived from the weights; the COP fields stay kCopNone unless the frame
+// carries them. Stream chunks pass the swing's `carry`, which must have
+// seen every chunk since the last keyframe. Returns false on a truncated
+// frame, or on a carried chunk without that state.
+inline bool decodeFrameSamples(const uint8_t* data, size_t size, const FrameHeader& h, SwingSample* out,
+                               TraceState* carry = nullptr) {
+    const uint32_t tickUs = h.tickUs;
+    const int32_t lsb = h.gramsPerLsb;
+    const bool withFraction = h.flags & kFlagLeadFraction;
+    const bool withCop = h.flags & kFlagCenterOfPressure;
+    for (size_t i = 0; i < h.count; i++) out[i].copXMm = out[i].copYMm = kCopNone;
+    if (h.flags & kFlagPredictedVarint) {
+        if ((h.flags & kFlagCarriedPredictor) && !carry) return false;
+        TraceState state;
+        if (carry && (h.flags & kFlagCarriedPredictor)) state = *carry;
+        state.ticks.shift(static_cast<int32_t>(h.t0Ticks - state.firstTick));
+        state.firstTick = h.t0Ticks;
+        size_t offset = readPredictedColumn(data, size, kFrameHeaderSize, h.count, state.ticks, [&](size_t i, int32_t v) {
+            out[i].tUs = (h.t0Ticks + static_cast<uint32_t>(v)) * tickUs;
+        });
+        if (offset) offset = readPredictedColumn(data, size, offset, h.count, state.lead, [&](size_t i, int32_t v) {
+            out[i].leadGrams = v * lsb;
+        });
+        if (offset) offset = readPredictedColumn(data, size, offset, h.count, state.trail, [&](size_t i, int32_t v) {
+            out[i].trailGrams = v * lsb;
+        });
+        if (offset && withFraction) {
+            offset = readPredictedColumn(data, size, offset, h.count, state.fraction, [](size_t, int32_t) {});
+        }
+        if (offset && withCop) {
+            offset = readPredictedColumn(data, size, offset, h.count, state.copX, [&](size_t i, int32_t v) {
+                out[i].copXMm = static_cast<int16_t>(v);
+            });
+            if (offset) offset = readPredictedColumn(data, size, offset, h.count, state.copY, [&](size_t i, int32_t v) {
+                out[i].copYMm = static_cast<int16_t>(v);
+            });
+        }
+        if (offset == 0 && h.count != 0) return false;
+        if (carry) *carry = state;
+        return true;
+    }
+
+    if (size < swingFrameSize(h.count, h.flags)) return false;
+    const uint8_t* deltas = data + kFrameHeaderSize;
+    const uint8_t* lead = deltas + h.count * 2;
+    const uint8_t* trail = lead + h.count * 2;
+    const uint8_t* copX = trail + h.count * (withFraction ? 4 : 2);
+    const uint8_t* copY = copX + h.count * 2;
+    uint32_t tick = h.t0Ticks;
+    for (size_t i = 0; i < h.count; i++) {
+        tick += getU16(deltas + i * 2);
+        out[i].tUs = tick * tickUs;
+        out[i].leadGrams = static_cast<int16_t>(getU16(lead + i * 2)) * lsb;
+        out[i].trailGrams = static_cast<int16_t>(getU16(trail + i * 2)) * lsb;
+        if (withCop) {
+            out[i].copXMm = static_cast<int16_t>(getU16(copX + i * 2));
+            out[i].copYMm = static_cast<int16_t>(getU16(copY + i * 2));
+        }
+    }
+    return true;
+}
+
+}  // namespace pressurepad
@@ -0,0 +1,402 @@
+// Ingest daemon: keeps a BLE connection to every pad in range, appends
+// their swings and messages to an mmap'd store and relays every
+// notification to pages over a local WebSocket (index.html?host=ws://...).
+// Everything except the BLE backend's callbacks and GATT writes runs on
+// one epoll loop.
+//
+// A pad that drops keeps its swing assembly. When it comes back the daemon
+// resumes the interrupted upload (RESUME?) and acknowledges every stored
+// swing (ACK:), as the page does over Web Bluetooth. Swings that still
+// arrive with gaps are stored flagged kRecordIncomplete.
+//
+//   g++ -std=c++17 -O2 -pthread host/pad_daemon.cpp -o pad_daemon
+//       (add -DPRESSUREPAD_HAVE_SIMPLEBLE -lsimpleble for the BLE backend)
+//   ./pad_daemon [--port 8765] [--bind 127.0.0.1] [--store pads.ppst]
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "../firmware/device_config.h"
+#include "../firmware/event_channel.h"
+#include "../firmware/swing_metrics.h"
+#include "../firmware/swing_transfer.h"
+#include "event_loop.h"
+#include "pad_link.h"
+#include "relay_protocol.h"
+#include "swing_assembler.h"
+#include "swing_store.h"
+#include "websocket.h"
+
+using namespace pressurepad;
+
+namespace {
+
+// A page that stops reading is dropped rather than buffering without bound.
+constexpr size_t kMaxClientBacklog = 8 << 20;
+
+uint64_t nowUs() {
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+struct Client {
+    int fd = -1;
+    WebSocketSession session;
+    bool closing = false;
+};
+
+struct Board {
+    std::string name;
+    bool connected = false;
+    SwingAssembler assembler;
+    // Resume state, as board.transfer on the page (resumeTransfer() there).
+    bool stored = false;        // lastSwingSeq names a stored swing
+    uint16_t lastSwingSeq = 0;
+    bool named = false;         // swingSeq names the swing in progress
+    uint16_t swingSeq = 0;
+    uint16_t heldFrames = 0;    // how far the board can resend an overflowed swing, 0 if it did not overflow
+};
+
+class Daemon : public PadEvents {
+public:
+    Daemon(EventLoop& loop, SwingStore& store, PadLink& link) : loop_(loop), store_(store), link_(link) {}
+
+    // PadEvents, called on backend threads.
+    void connected(const std::string& id, const std::string& name) override {
+        loop_.post([this, id, name] {
+            const bool returning = boards_.count(id) != 0;
+            Board& board = boards_[id];
+            board.name = name;
+            board.connected = true;
+            fprintf(stderr, "pad %s %s\n", id.c_str(), returning ? "reconnected" : "connected");
+            broadcast(encodeRelay(RelayKind::Connected, id, name));
+            if (returning) link_.write(id, "RESUME?");
+        });
+    }
+
+    void notified(const std::string& id, PadChannel channel, std::string bytes) override {
+        const uint64_t receivedUs = nowUs();
+        loop_.post([this, id, channel, receivedUs, bytes] {
+            broadcast(encodeRelay(relayKind(channel), id, bytes));
+            // Diagnostics are live state, not part of the session record.
+            if (channel != PadChannel::Diagnostics) record(id, receivedUs, bytes);
+        });
+    }
+
+    void disconnected(const std::string& id) override {
+        loop_.post([this, id] {
+            auto it = boards_.find(id);
+            if (it != boards_.end()) it->second.connected = false;
+            fprintf(stderr, "pad %s disconnected\n", id.c_str());
+            broadcast(encodeRelay(RelayKind::Disconnected, id, std::string()));
+        });
+    }
+
+    void accept(int listener) {
+        for (;;) {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            auto client = std::make_shared<Client>();
+            client->fd = fd;
+            clients_[fd] = client;
+            loop_.add(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { onClient(fd, events); });
+        }
+    }
+
+    void closeAll() {
+        while (!clients_.empty()) drop(clients_.begin()->first);
+    }
+
+private:
+    static RelayKind relayKind(PadChannel channel) {
+        switch (channel) {
+            case PadChannel::Event: return RelayKind::Event;
+            case PadChannel::Diagnostics: return RelayKind::Diagnostics;
+            case PadChannel::Data: break;
+        }
+        return RelayKind::Data;
+    }
+
+    void record(const std::string& id, uint64_t receivedUs, const std::string& bytes) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.data());
+        const size_t size = bytes.size();
+        if (!isBinaryFrame(data, size)) {
+            store_.append(RecordKind::Text, id, receivedUs, data, size);
+            return;
+        }
+        switch (data[2]) {
+            case kMsgSwing:
+            case kMsgChunk:
+            case kMsgSwingEnd: {
+                Board& board = boards_[id];
+                AssembledSwing swing;
+                if (board.assembler.feed(data, size, swing)) {
+                    storeSwing(id, board, receivedUs, swing);
+                } else if (data[2] == kMsgChunk && board.heldFrames != 0 &&
+                           getU16(data + 10) + 1 >= board.heldFrames) {
+                    finishHeld(id, board, receivedUs);
+                }
+                break;
+            }
+            case kMsgResume:
+                resumeTransfer(id, boards_[id], receivedUs, data, size);
+                break;
+            case kMsgSummary:
+                store_.append(RecordKind::Summary, id, receivedUs, data, size);
+                break;
+            case kMsgEvent:
+                if (size >= kEventFrameSize && data[3] == static_cast<uint8_t>(EventCode::StartSwing)) {
+                    boards_[id].named = false;
+                }
+                store_.append(RecordKind::Event, id, receivedUs, data, size);
+                break;
+            case kMsgConfig:
+                store_.append(RecordKind::Config, id, receivedUs, data, size);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // A swing the board numbered is acknowledged once stored; it is stored
+    // only once, however often it was resent.
+    void storeSwing(const std::string& id, Board& board, uint64_t receivedUs, const AssembledSwing& swing) {
+        const bool repeat = swing.swingSeq != 0 && board.stored && swing.swingSeq == board.lastSwingSeq;
+        if (!repeat) {
+            SwingRecordInfo info;
+            info.flags = swing.complete() ? 0 : kRecordIncomplete;
+            info.missedChunks = static_cast<uint8_t>(swing.missedChunks > UINT8_MAX ? UINT8_MAX : swing.missedChunks);
+            info.expectedSamples = static_cast<uint16_t>(swing.expected);
+            store_.append(RecordKind::Swing, id, receivedUs, swing.frame.data(), swing.frame.size(), info);
+            if (swing.truncated) {
+                fprintf(stderr, "pad %s: swing stored incomplete (upload cut short at %zu samples, %u chunks missed)\n",
+                        id.c_str(), swing.samples, static_cast<unsigned>(swing.missedChunks));
+            } else if (!swing.complete()) {
+                fprintf(stderr, "pad %s: swing stored incomplete (%zu/%zu samples, %u chunks missed)\n", id.c_str(),
+                        swing.samples, swing.expected, static_cast<unsigned>(swing.missedChunks));
+            }
+        }
+        board.named = false;
+        board.heldFrames = 0;
+        if (swing.swingSeq == 0) return;
+        board.stored = true;
+        board.lastSwingSeq = swing.swingSeq;
+        if (board.connected) link_.write(id, "ACK:" + std::to_string(swing.swingSeq));
+    }
+
+    // The board cannot resend the rest of an overflowed swing.
+    void finishHeld(const std::string& id, Board& board, uint64_t receivedUs) {
+        AssembledSwing swing;
+        if (board.assembler.finishPartial(board.swingSeq, swing)) {
+            storeSwing(id, board, receivedUs, swing);
+        } else {
+            board.heldFrames = 0;
+            if (board.connected) link_.write(id, "ACK:" + std::to_string(board.swingSeq));
+        }
+    }
+
+    // Reply to RESUME? (see swing_transfer.h): continue the interrupted
+    // swing from the first missing chunk, fetch one that was lost entirely
+    // from chunk 0, or acknowledge one already stored. An overflowed swing
+    // is resumed only up to what the board holds and then stored as it is;
+    // with nothing past what arrived there is nothing to ask for, and a
+    // swing that did not overflow is still being captured and goes on live.
+    void resumeTransfer(const std::string& id, Board& board, uint64_t receivedUs, const uint8_t* data, size_t size) {
+        FrameHeader h;
+        if (!readFrameHeader(data, size, h)) return;
+        const uint16_t swingSeq = static_cast<uint16_t>(h.t0Ticks);
+        if (h.count == 0 || swingSeq == 0) return;
+        if (board.stored && swingSeq == board.lastSwingSeq) {
+            link_.write(id, "ACK:" + std::to_string(swingSeq));
+            return;
+        }
+        const bool known = board.named || board.stored;
+        const uint16_t inProgress = board.named ? board.swingSeq : static_cast<uint16_t>(board.lastSwingSeq + 1);
+        const bool resuming = board.assembler.inSwing() && known && swingSeq == inProgress;
+        board.named = true;
+        board.swingSeq = swingSeq;
+        board.heldFrames = (h.reserved & kResumeOverflowed) ? h.count : 0;
+        if (resuming && h.count <= board.assembler.nextChunk()) {
+            if (board.heldFrames != 0) finishHeld(id, board, receivedUs);
+            return;
+        }
+        const uint16_t from = resuming ? board.assembler.nextChunk() : 0;
+        link_.write(id, "RESUME:" + std::to_string(swingSeq) + ":" + std::to_string(from));
+    }
+
+    void broadcast(const std::string& message) {
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            auto client = (it++)->second;
+            if (client->session.state() != WebSocketSession::State::Open) continue;
+            client->session.sendBinary(message);
+            flush(*client);
+        }
+    }
+
+    void onClient(int fd, uint32_t events) {
+        auto it = clients_.find(fd);
+        if (it == clients_.end()) return;
+        auto client = it->second;
+        if (events & EPOLLIN) {
+            char buffer[16384];
+            for (;;) {
+                ssize_t n = read(fd, buffer, sizeof buffer);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                    drop(fd);
+                    return;
+                }
+                if (n < 0) break;
+                const bool wasOpen = client->session.state() == WebSocketSession::State::Open;
+                const bool keep = client->session.feed(buffer, static_cast<size_t>(n),
+                                                       [this](const std::string& message, bool binary) {
+                                                           if (binary) onPageMessage(message);
+                                                       });
+                if (!wasOpen && client->session.state() == WebSocketSession::State::Open) greet(*client);
+                if (!keep) client->closing = true;
+            }
+        }
+        if ((events & (EPOLLHUP | EPOLLERR)) != 0) {
+            drop(fd);
+            return;
+        }
+        flush(*client);
+    }
+
+    // A page that connects mid-session learns about the pads already up.
+    void greet(Client& client) {
+        for (const auto& board : boards_) {
+            if (!board.second.connected) continue;
+            client.session.sendBinary(encodeRelay(RelayKind::Connected, board.first, board.second.name));
+        }
+    }
+
+    void onPageMessage(const std::string& message) {
+        RelayKind kind;
+        std::string id, payload;
+        if (!decodeRelay(message, kind, id, payload) || kind != RelayKind::Write) return;
+        link_.write(id, payload);
+    }
+
+    void flush(Client& client) {
+        std::string& out = client.session.outbox();
+        while (!out.empty()) {
+            ssize_t n = send(client.fd, out.data(), out.size(), MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EINTR) break;
+                drop(client.fd);
+                return;
+            }
+            out.erase(0, static_cast<size_t>(n));
+        }
+        if (out.size() > kMaxClientBacklog || (out.empty() && client.closing)) {
+            drop(client.fd);
+            return;
+        }
+        loop_.modify(client.fd, EPOLLIN | EPOLLRDHUP | (out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT)));
+    }
+
+    void drop(int fd) {
+        loop_.remove(fd);
+        ::close(fd);
+        clients_.erase(fd);
+    }
+
+    EventLoop& loop_;
+    SwingStore& store_;
+    PadLink& link_;
+    std::map<std::string, Board> boards_;
+    std::map<int, std::shared_ptr<Client>> clients_;
+};
+
+int listenOn(const char* address, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address, &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || listen(fd, 16) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int port = 8765;
+    const char* address = "127.0.0.1";
+    const char* storePath = "pads.ppst";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--port") == 0) {
+            port = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--bind") == 0) {
+            address = argv[i + 1];
+        } else if (strcmp(argv[i], "--store") == 0) {
+            storePath = argv[i + 1];
+        } else {
+            fprintf(stderr, "usage: %s [--port N] [--bind ADDR] [--store FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    SwingStore store;
+    if (!store.open(storePath)) {
+        fprintf(stderr, "cannot open store %s: %s\n", storePath, strerror(errno));
+        return 1;
+    }
+    fprintf(stderr, "store %s: %zu records\n", storePath, store.records());
+
+    EventLoop loop;
+    if (!loop.valid()) return 1;
+
+    int listener = listenOn(address, port);
+    if (listener < 0) {
+        fprintf(stderr, "cannot listen on %s:%d: %s\n", address, port, strerror(errno));
+        return 1;
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    std::unique_ptr<PadLink> link = createPadLink();
+    Daemon daemon(loop, store, *link);
+    loop.add(listener, EPOLLIN, [&](uint32_t) { daemon.accept(listener); });
+    loop.add(signalFd, EPOLLIN, [&](uint32_t) { loop.stop(); });
+
+    fprintf(stderr, "listening on ws://%s:%d\n", address, port);
+    link->start(daemon);
+    loop.run();
+
+    link->stop();
+    daemon.closeAll();
+    ::close(listener);
+    ::close(signalFd);
+    store.close();
+    fprintf(stderr, "stored %zu records\n", store.records());
+    return 0;
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+// BLE side of the ingest daemon: finds pads advertising as ESP32_PRESSURE,
+// keeps a connection to every one of them and reports notifications on the
+// same service and characteristics the page uses. Callbacks arrive on the
+// backend's own threads; the daemon posts them into its event loop.
+// Writes to a pad are queued and sent from the link's own writer thread.
+//
+// The backend is SimpleBLE (define PRESSUREPAD_HAVE_SIMPLEBLE and link
+// -lsimpleble). Without it createPadLink() returns a link that never finds
+// a pad, so the store and WebSocket side still run.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "../firmware/diagnostics.h"
+#include "../firmware/event_channel.h"
+
+namespace pressurepad {
+
+constexpr const char* kPadName = "ESP32_PRESSURE";
+constexpr const char* kServiceUuid = "4fafc201-1fb5-459e-8fcc-c5c9c331914b";
+constexpr const char* kDataCharUuid = "beb5483e-36e1-4688-b7f5-ea07361b26a8";
+
+enum class PadChannel : uint8_t { Data, Event, Diagnostics };
+
+class PadEvents {
+public:
+    virtual ~PadEvents() = default;
+    virtual void connected(const std::string& id, const std::string& name) = 0;
+    virtual void notified(const std::string& id, PadChannel channel, std::string bytes) = 0;
+    virtual void disconnected(const std::string& id) = 0;
+};
+
+class PadLink {
+public:
+    virtual ~PadLink() = default;
+    virtual void start(PadEvents& events) = 0;
+    virtual void stop() = 0;
+    // Writes to the data characteristic; an empty id means every pad.
+    virtual void write(const std::string& id, const std::string& bytes) = 0;
+};
+
+}  // namespace pressurepad
+
+#if defined(PRESSUREPAD_HAVE_SIMPLEBLE)
+
+#include <simpleble/SimpleBLE.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace pressurepad {
+
+class SimpleBlePadLink : public PadLink {
+public:
+    static constexpr int kScanMs = 1500;
+    static constexpr int kRescanMs = 2000;
+
+    ~SimpleBlePadLink() override { stop(); }
+
+    void start(PadEvents& events) override {
+        events_ = &events;
+        running_ = true;
+        scanner_ = std::thread([this] { scanLoop(); });
+        writer_ = std::thread([this] { writeLoop(); });
+    }
+
+    void stop() override {
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            running_ = false;
+        }
+        writesQueued_.notify_all();
+        if (scanner_.joinable()) scanner_.join();
+        if (writer_.joinable()) writer_.join();
+        std::vector<Connecting> connecting;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connecting.swap(connecting_);
+        }
+        for (auto& c : connecting) c.thread.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pad : pads_) {
+            try {
+                pad.second.disconnect();
+            } catch (const std::exception&) {
+            }
+        }
+        pads_.clear();
+    }
+
+    // Called from the daemon's event loop. A GATT write blocks until the
+    // pad acknowledges it, so writes are queued for the writer thread
+    // rather than holding up every socket.
+    void write(const std::string& id, const std::string& bytes) override {
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            writes_.emplace_back(id, bytes);
+        }
+        writesQueued_.notify_one();
+    }
+
+private:
+    void writeLoop() {
+        while (true) {
+            std::pair<std::string, std::string> next;
+            {
+                std::unique_lock<std::mutex> lock(writeMutex_);
+                writesQueued_.wait(lock, [this] { return !running_ || !writes_.empty(); });
+                if (!running_) return;
+                next = std::move(writes_.front());
+                writes_.pop_front();
+            }
+            const std::string& id = next.first;
+            std::vector<SimpleBLE::Peripheral> targets;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto& pad : pads_) {
+                    if (id.empty() || pad.first == id) targets.push_back(pad.second);
+                }
+            }
+            for (auto& peripheral : targets) {
+                try {
+                    peripheral.write_request(kServiceUuid, kDataCharUuid, SimpleBLE::ByteArray(next.second));
+                } catch (const std::exception&) {
+                    // The disconnect callback reports the lost pad.
+                }
+            }
+        }
+    }
+
+    void scanLoop() {
+        auto adapters = SimpleBLE::Adapter::get_adapters();
+        if (adapters.empty()) return;
+        SimpleBLE::Adapter adapter = adapters.front();
+        while (running_) {
+            reapConnecting();
+            adapter.scan_for(kScanMs);
+            for (auto& peripheral : adapter.scan_get_results()) {
+                if (peripheral.identifier() != kPadName) continue;
+                const std::string id = peripheral.address();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (pads_.count(id) || pending_.count(id)) continue;
+                    pending_.insert(id);
+                    // Connecting blocks for the whole GATT discovery, so each
+                    // pad gets its own thread and a slow pad never holds up
+                    // the others.
+                    auto done = std::make_shared<std::atomic<bool>>(false);
+                    std::thread thread([this, peripheral, id, done]() mutable {
+                        connect(peripheral, id);
+                        done->store(true);
+                    });
+                    connecting_.push_back({std::move(thread), std::move(done)});
+                }
+            }
+            for (int waited = 0; running_ && waited < kRescanMs; waited += 100) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+    }
+
+    // Joins the connect threads that have finished, so a pad that keeps
+    // dropping and reconnecting does not pile up thread handles.
+    void reapConnecting() {
+        std::vector<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = connecting_.begin(); it != connecting_.end();) {
+                if (it->done->load()) {
+                    finished.push_back(std::move(it->thread));
+                    it = connecting_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (auto& t : finished) t.join();
+    }
+
+    void connect(SimpleBLE::Peripheral peripheral, const std::string& id) {
+        try {
+            peripheral.connect();
+            peripheral.set_callback_on_disconnected([this, id] {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    pads_.erase(id);
+                }
+                events_->disconnected(id);
+            });
+            peripheral.notify(kServiceUuid, kDataCharUuid, [this, id](SimpleBLE::ByteArray bytes) {
+                events_->notified(id, PadChannel::Data, std::string(bytes));
+            });
+            bool hasEvents = false;
+            bool hasDiagnostics = false;
+            for (auto& service : peripheral.services()) {
+                if (service.uuid() != kServiceUuid) continue;
+                for (auto& characteristic : service.characteristics()) {
+                    hasEvents = hasEvents || characteristic.uuid() == kEventCharUuid;
+                    hasDiagnostics = hasDiagnostics || characteristic.uuid() == kDiagnosticsCharUuid;
+                }
+            }
+            if (hasEvents) {
+                peripheral.notify(kServiceUuid, kEventCharUuid, [this, id](SimpleBLE::ByteArray bytes) {
+                    events_->notified(id, PadChannel::Event, std::string(bytes));
+                });
+            }
+            if (hasDiagnostics) {
+                peripheral.notify(kServiceUuid, kDiagnosticsCharUuid, [this, id](SimpleBLE::ByteArray bytes) {
+                    events_->notified(id, PadChannel::Diagnostics, std::string(bytes));
+                });
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pads_.emplace(id, peripheral);
+                pending_.erase(id);
+            }
+            events_->connected(id, peripheral.identifier());
+            // Same negotiation as the page: ask for the chunked, compressed
+            // stream and the board's configuration.
+            for (const char* command : {"FMT:STREAM", "CODEC:LPV", "CFG?"}) {
+                peripheral.write_request(kServiceUuid, kDataCharUuid, SimpleBLE::ByteArray(std::string(command)));
+            }
+        } catch (const std::exception&) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pads_.erase(id);
+            pending_.erase(id);
+            // The next scan retries the pad if it is still advertising.
+        }
+    }
+
+    struct Connecting {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    PadEvents* events_ = nullptr;
+    std::atomic<bool> running_{false};
+    std::thread scanner_;
+    std::thread writer_;
+    std::mutex mutex_;
+    std::map<std::string, SimpleBLE::Peripheral> pads_;
+    std::set<std::string> pending_;
+    std::vector<Connecting> connecting_;
+    std::mutex writeMutex_;
+    std::condition_variable writesQueued_;
+    std::deque<std::pair<std::string, std::string>> writes_;
+};
+
+inline std::unique_ptr<PadLink> createPadLink() {
+    return std::unique_ptr<PadLink>(new SimpleBlePadLink());
+}
+
+}  // namespace pressurepad
+
+#else  // PRESSUREPAD_HAVE_SIMPLEBLE
+
+namespace pressurepad {
+
+class NullPadLink : public PadLink {
+public:
+    void start(PadEvents&) override {}
+    void stop() override {}
+    void write(const std::string&, const std::string&) override {}
+};
+
+inline std::unique_ptr<PadLink> createPadLink() {
+    return std::unique_ptr<PadLink>(new NullPadLink());
+}
+
+}  // namespace pressurepad
+
+#endif  // PRESSUREPAD_HAVE_SIMPLEBLE
@@ -0,0 +1,51 @@
+#pragma once
+
+// Messages between the ingest daemon and the page, one per binary
+// WebSocket message:
+//   0  u8   kind (RelayKind)
+//   1  u8   board id length
+//   2  board id bytes, then the payload
+// Data, Event and Diagnostics carry a notification exactly as the pad sent
+// it on the data, event or diagnostics characteristic, so the page feeds it
+// to the same ingest path as a Web Bluetooth notification. Connected carries the pad's
+// advertised name. Write goes the other way and is written to the pad's
+// data characteristic; an empty id means every connected pad.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace pressurepad {
+
+enum class RelayKind : uint8_t {
+    Data = 0x01,
+    Event = 0x02,
+    Connected = 0x03,
+    Disconnected = 0x04,
+    Diagnostics = 0x05,
+    Write = 0x10,
+};
+
+inline std::string encodeRelay(RelayKind kind, const std::string& boardId, const std::string& payload) {
+    const size_t idLength = boardId.size() > UINT8_MAX ? UINT8_MAX : boardId.size();
+    std::string out;
+    out.reserve(2 + idLength + payload.size());
+    out.push_back(static_cast<char>(kind));
+    out.push_back(static_cast<char>(idLength));
+    out.append(boardId, 0, idLength);
+    out.append(payload);
+    return out;
+}
+
+inline bool decodeRelay(const std::string& message, RelayKind& kind, std::string& boardId, std::string& payload) {
+    if (message.size() < 2) return false;
+    const size_t idLength = static_cast<uint8_t>(message[1]);
+    if (message.size() < 2 + idLength) return false;
+    kind = static_cast<RelayKind>(message[0]);
+    boardId = message.substr(2, idLength);
+    payload = message.substr(2 + idLength);
+    return true;
+}
+
+}  // namespace pressurepad
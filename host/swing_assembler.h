@@ -0,0 +1,142 @@
+#pragma once
+
+// Rebuilds whole swings from one board's notifications: a kMsgSwing frame
+// is a swing on its own, stream chunks are collected from sequence 0 until
+// kMsgSwingEnd. The finished swing is re-encoded as a single compressed
+// kMsgSwing frame, which is what the store keeps and what the page's
+// decoder already reads.
+//
+// Chunks resent after a reconnect (swing_transfer.h) are dropped if they
+// already arrived, as in the page's ingest worker: one behind the next
+// expected sequence, or a chunk 0 identical to the first one.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "../firmware/swing_stream.h"
+#include "frame_decoder.h"
+
+namespace pressurepad {
+
+struct AssembledSwing {
+    std::vector<uint8_t> frame;
+    size_t samples = 0;
+    size_t expected = 0;    // count announced by kMsgSwingEnd, 0 for kMsgSwing or a truncated swing
+    uint16_t missedChunks = 0;
+    uint16_t swingSeq = 0;  // from kMsgSwingEnd, 0 when the board did not number it
+    bool truncated = false;  // ended by finishPartial(), without kMsgSwingEnd
+
+    bool complete() const { return !truncated && missedChunks == 0 && (expected == 0 || samples == expected); }
+};
+
+class SwingAssembler {
+public:
+    // Returns true and fills `swing` when `data` completed a swing.
+    bool feed(const uint8_t* data, size_t size, AssembledSwing& swing) {
+        FrameHeader h;
+        if (!readFrameHeader(data, size, h)) return false;
+        if (h.type == kMsgSwing) {
+            std::vector<SwingSample> samples(h.count);
+            if (h.count == 0 || !decodeFrameSamples(data, size, h, samples.data())) return false;
+            return finish(samples, h, 0, 0, swing);
+        }
+        if (h.type == kMsgChunk) {
+            const uint16_t seq = h.reserved;
+            if (seq == 0) {
+                if (firstChunk_.size() == size && memcmp(firstChunk_.data(), data, size) == 0) return false;
+                reset();
+                firstChunk_.assign(data, data + size);
+            }
+            if (seq != 0 && static_cast<uint16_t>(nextSeq_ - seq - 1) < 0x8000) return false;
+            inSwing_ = true;
+            const bool inOrder = seq == nextSeq_ && carryValid_;
+            if (seq != nextSeq_) missed_ += static_cast<uint16_t>(seq - nextSeq_);
+            nextSeq_ = static_cast<uint16_t>(seq + 1);
+            // A carried chunk after a gap cannot be decoded; it counts as
+            // missed, like the gap, until the next keyframe.
+            if ((h.flags & kFlagCarriedPredictor) && !inOrder) {
+                missed_++;
+                carryValid_ = false;
+                return false;
+            }
+            const size_t at = samples_.size();
+            samples_.resize(at + h.count);
+            if (!decodeFrameSamples(data, size, h, samples_.data() + at, &carry_)) {
+                samples_.resize(at);
+                carryValid_ = false;
+                return false;
+            }
+            carryValid_ = true;
+            header_ = h;
+            return false;
+        }
+        if (h.type == kMsgSwingEnd) {
+            bool done = !samples_.empty() && finish(samples_, header_, h.count, missed_, swing);
+            swing.swingSeq = static_cast<uint16_t>(h.t0Ticks);
+            reset();
+            return done;
+        }
+        return false;
+    }
+
+    // Ends the swing in progress with what arrived, for a board that can no
+    // longer send the rest (kResumeOverflowed). Returns false if nothing did.
+    bool finishPartial(uint16_t swingSeq, AssembledSwing& swing) {
+        bool done = !samples_.empty() && finish(samples_, header_, 0, missed_, swing);
+        swing.swingSeq = swingSeq;
+        swing.truncated = true;
+        reset();
+        return done;
+    }
+
+    // A swing is in progress once one of its chunks arrived.
+    bool inSwing() const { return inSwing_; }
+    uint16_t nextChunk() const { return nextSeq_; }
+
+    void reset() {
+        samples_.clear();
+        firstChunk_.clear();
+        inSwing_ = false;
+        nextSeq_ = 0;
+        missed_ = 0;
+        carry_ = TraceState();
+        carryValid_ = true;
+    }
+
+private:
+    static bool finish(const std::vector<SwingSample>& samples, const FrameHeader& h, size_t expected,
+                       uint16_t missed, AssembledSwing& swing) {
+        FrameConfig cfg;
+        cfg.tickUs = h.tickUs;
+        cfg.gramsPerLsb = h.gramsPerLsb;
+        cfg.flags = static_cast<uint8_t>(kFlagLeadFraction | kFlagPredictedVarint | (h.flags & kFlagCenterOfPressure));
+        swing.frame.resize(swingFrameSize(samples.size(), cfg.flags));
+        size_t size = encodeSwingFrame(samples.data(), samples.size(), swing.frame.data(), swing.frame.size(), cfg);
+        // Chunks split at gaps too long for a 16-bit delta; the whole swing
+        // takes a coarser tick instead.
+        while (size == 0 && samples.size() <= UINT16_MAX && cfg.tickUs <= UINT16_MAX / 2) {
+            cfg.tickUs = static_cast<uint16_t>(cfg.tickUs * 2);
+            size = encodeSwingFrame(samples.data(), samples.size(), swing.frame.data(), swing.frame.size(), cfg);
+        }
+        if (size == 0) return false;
+        swing.frame.resize(size);
+        swing.samples = samples.size();
+        swing.expected = expected;
+        swing.missedChunks = missed;
+        return true;
+    }
+
+    std::vector<SwingSample> samples_;
+    std::vector<uint8_t> firstChunk_;
+    FrameHeader header_;
+    TraceState carry_;
+    uint16_t nextSeq_ = 0;
+    uint16_t missed_ = 0;
+    bool carryValid_ = true;
+    bool inSwing_ = false;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,194 @@
+#pragma once
+
+// Append-only record log in one memory-mapped file. Records are only ever
+// added at the end, and a record's size word is written last, so a reader
+// (or a restart after a crash) stops cleanly at the first record that was
+// never completed.
+//
+// File layout (little-endian):
+//   0  char[4] "PPST"
+//   4  u32     version
+//   8  u64     reserved
+//   16 records, each 8-byte aligned:
+//        0  u32  record size including this header and padding, 0 = end
+//        4  u32  payload length
+//        8  u16  kind (RecordKind)
+//        10 u16  board id length
+//        12 u8   flags (RecordFlags)
+//        13 u8   chunks missed while assembling, saturating at 255
+//        14 u16  sample count the board announced, 0 if unknown
+//        16 u64  receive time, microseconds since the Unix epoch
+//        24 board id bytes, then the payload
+// Swing payloads are compressed kMsgSwing frames (see swing_assembler.h);
+// the other kinds keep the notification exactly as it arrived. Bytes 12-15
+// describe swings only and are zero for every other kind, as they are in
+// files written before they were defined.
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+
+#include "frame_decoder.h"
+
+namespace pressurepad {
+
+enum class RecordKind : uint16_t {
+    Swing = 1,
+    Summary = 2,
+    Event = 3,
+    Config = 4,
+    Text = 5,
+};
+
+enum RecordFlags : uint8_t {
+    // Gaps, a short sample count or an upload the board could not finish:
+    // the record holds only what arrived.
+    kRecordIncomplete = 0x01,
+};
+
+// Describes how a swing record was assembled.
+struct SwingRecordInfo {
+    uint8_t flags = 0;
+    uint8_t missedChunks = 0;
+    uint16_t expectedSamples = 0;
+};
+
+class SwingStore {
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kFileHeaderSize = 16;
+    static constexpr size_t kRecordHeaderSize = 24;
+    static constexpr size_t kMinCapacity = 1 << 20;
+
+    SwingStore() = default;
+    SwingStore(const SwingStore&) = delete;
+    SwingStore& operator=(const SwingStore&) = delete;
+    ~SwingStore() { close(); }
+
+    // Opens or creates the store and finds the end of the log.
+    bool open(const char* path) {
+        fd_ = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) return false;
+        const bool fresh = st.st_size == 0;
+        if (!map(fresh ? kMinCapacity : static_cast<size_t>(st.st_size))) return false;
+        if (fresh) {
+            memcpy(base_, "PPST", 4);
+            putU32(base_ + 4, kVersion);
+        } else if (memcmp(base_, "PPST", 4) != 0 || getU32(base_ + 4) > kVersion) {
+            return false;
+        }
+        end_ = kFileHeaderSize;
+        while (end_ + kRecordHeaderSize <= capacity_) {
+            uint32_t size = getU32(base_ + end_);
+            if (size < kRecordHeaderSize || end_ + size > capacity_) break;
+            end_ += size;
+            records_++;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_) {
+            msync(base_, capacity_, MS_SYNC);
+            munmap(base_, capacity_);
+        }
+        if (fd_ >= 0) ::close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+        capacity_ = 0;
+        end_ = 0;
+        records_ = 0;
+    }
+
+    bool append(RecordKind kind, const std::string& boardId, uint64_t receivedUs, const uint8_t* data, size_t size,
+                const SwingRecordInfo& info = SwingRecordInfo()) {
+        const size_t idLength = boardId.size() > UINT16_MAX ? UINT16_MAX : boardId.size();
+        const size_t total = (kRecordHeaderSize + idLength + size + 7) & ~static_cast<size_t>(7);
+        if (!base_ || total > UINT32_MAX) return false;
+        if (end_ + total + kRecordHeaderSize > capacity_ && !grow(end_ + total + kRecordHeaderSize)) return false;
+
+        uint8_t* record = base_ + end_;
+        putU32(record + 4, static_cast<uint32_t>(size));
+        putU16(record + 8, static_cast<uint16_t>(kind));
+        putU16(record + 10, static_cast<uint16_t>(idLength));
+        record[12] = info.flags;
+        record[13] = info.missedChunks;
+        putU16(record + 14, info.expectedSamples);
+        putU32(record + 16, static_cast<uint32_t>(receivedUs));
+        putU32(record + 20, static_cast<uint32_t>(receivedUs >> 32));
+        memcpy(record + kRecordHeaderSize, boardId.data(), idLength);
+        memcpy(record + kRecordHeaderSize + idLength, data, size);
+        memset(record + kRecordHeaderSize + idLength + size, 0, total - kRecordHeaderSize - idLength - size);
+        std::atomic_thread_fence(std::memory_order_release);
+        putU32(record, static_cast<uint32_t>(total));
+        end_ += total;
+        records_++;
+        return true;
+    }
+
+    // Calls visit(kind, boardId, receivedUs, payload, payloadSize, info) for
+    // every complete record, oldest first.
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        for (size_t at = kFileHeaderSize; at < end_;) {
+            const uint8_t* record = base_ + at;
+            const uint32_t size = getU32(record);
+            const uint16_t idLength = getU16(record + 10);
+            const uint64_t receivedUs = getU32(record + 16) | (static_cast<uint64_t>(getU32(record + 20)) << 32);
+            const uint8_t* payload = record + kRecordHeaderSize + idLength;
+            SwingRecordInfo info;
+            info.flags = record[12];
+            info.missedChunks = record[13];
+            info.expectedSamples = getU16(record + 14);
+            visit(static_cast<RecordKind>(getU16(record + 8)),
+                  std::string(reinterpret_cast<const char*>(record + kRecordHeaderSize), idLength), receivedUs,
+                  payload, getU32(record + 4), info);
+            at += size;
+        }
+    }
+
+    size_t records() const { return records_; }
+    size_t bytes() const { return end_; }
+
+private:
+    // Allocates the blocks up front rather than leaving the file sparse: a
+    // full disk then fails here instead of raising SIGBUS on a later store
+    // through the mapping. On failure the current mapping is left as it is.
+    bool map(size_t capacity) {
+        if (posix_fallocate(fd_, 0, static_cast<off_t>(capacity)) != 0) return false;
+        void* base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) return false;
+        if (base_) {
+            msync(base_, capacity_, MS_ASYNC);
+            munmap(base_, capacity_);
+        }
+        base_ = static_cast<uint8_t*>(base);
+        capacity_ = capacity;
+        return true;
+    }
+
+    // Doubles the file; new blocks read as zero, so the log stays
+    // terminated. The old mapping stays valid until the new one is in.
+    bool grow(size_t needed) {
+        size_t capacity = capacity_;
+        while (capacity < needed) capacity *= 2;
+        return map(capacity);
+    }
+
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t capacity_ = 0;
+    size_t end_ = 0;
+    size_t records_ = 0;
+};
+
+}  // namespace pressurepad
@@ -0,0 +1,243 @@
+#pragma once
+
+// Minimal RFC 6455 server side for the daemon's local page feed: the
+// HTTP upgrade handshake, unmasking of client frames, fragmentation,
+// ping/pong and close. The session only transforms bytes; the daemon owns
+// the socket and flushes outbox() whenever it is non-empty.
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string>
+
+namespace pressurepad {
+
+namespace detail {
+
+inline uint32_t rotl(uint32_t v, int bits) {
+    return (v << bits) | (v >> (32 - bits));
+}
+
+inline std::array<uint8_t, 20> sha1(const std::string& message) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string data = message;
+    const uint64_t bits = static_cast<uint64_t>(message.size()) * 8;
+    data.push_back(static_cast<char>(0x80));
+    while (data.size() % 64 != 56) data.push_back(0);
+    for (int i = 7; i >= 0; i--) data.push_back(static_cast<char>(bits >> (i * 8)));
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data() + chunk + i * 4);
+            w[i] = (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 20; i++) digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+    return digest;
+}
+
+inline std::string base64(const uint8_t* data, size_t size) {
+    static const char* kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < size) v |= data[i + 1] << 8;
+        if (i + 2 < size) v |= data[i + 2];
+        out.push_back(kAlphabet[(v >> 18) & 63]);
+        out.push_back(kAlphabet[(v >> 12) & 63]);
+        out.push_back(i + 1 < size ? kAlphabet[(v >> 6) & 63] : '=');
+        out.push_back(i + 2 < size ? kAlphabet[v & 63] : '=');
+    }
+    return out;
+}
+
+// Value of an HTTP header, matched case-insensitively, or "" if absent.
+inline std::string headerValue(const std::string& request, const std::string& name) {
+    size_t lineStart = request.find("\r\n");
+    while (lineStart != std::string::npos) {
+        lineStart += 2;
+        size_t lineEnd = request.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos || lineEnd == lineStart) break;
+        size_t colon = request.find(':', lineStart);
+        if (colon != std::string::npos && colon < lineEnd && colon - lineStart == name.size()) {
+            bool match = true;
+            for (size_t i = 0; i < name.size() && match; i++) {
+                match = tolower(static_cast<unsigned char>(request[lineStart + i])) ==
+                        tolower(static_cast<unsigned char>(name[i]));
+            }
+            if (match) {
+                size_t valueStart = request.find_first_not_of(' ', colon + 1);
+                return request.substr(valueStart, lineEnd - valueStart);
+            }
+        }
+        lineStart = lineEnd;
+    }
+    return "";
+}
+
+}  // namespace detail
+
+class WebSocketSession {
+public:
+    static constexpr size_t kMaxMessageBytes = 1 << 20;
+
+    enum class State { Handshake, Open, Closed };
+
+    State state() const { return state_; }
+    std::string& outbox() { return outbox_; }
+
+    // Consumes bytes read from the socket and calls onMessage(payload,
+    // binary) for every complete message. Returns false once the session
+    // should be closed (after the outbox is flushed).
+    template <typename OnMessage>
+    bool feed(const char* data, size_t size, OnMessage&& onMessage) {
+        inbox_.append(data, size);
+        if (state_ == State::Handshake && !handshake()) return state_ != State::Closed;
+        while (state_ == State::Open) {
+            if (!nextFrame(onMessage)) break;
+        }
+        return state_ != State::Closed;
+    }
+
+    void sendBinary(const std::string& payload) { frame(0x2, payload); }
+
+    void close() {
+        if (state_ == State::Open) frame(0x8, std::string());
+        state_ = State::Closed;
+    }
+
+private:
+    bool handshake() {
+        const size_t end = inbox_.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (inbox_.size() > 8192) state_ = State::Closed;
+            return false;
+        }
+        const std::string request = inbox_.substr(0, end + 4);
+        inbox_.erase(0, end + 4);
+        const std::string key = detail::headerValue(request, "Sec-WebSocket-Key");
+        if (request.compare(0, 4, "GET ") != 0 || key.empty()) {
+            outbox_ += "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+            state_ = State::Closed;
+            return false;
+        }
+        const auto digest = detail::sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+        outbox_ += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                   "Sec-WebSocket-Accept: " + detail::base64(digest.data(), digest.size()) + "\r\n\r\n";
+        state_ = State::Open;
+        return true;
+    }
+
+    template <typename OnMessage>
+    bool nextFrame(OnMessage& onMessage) {
+        if (inbox_.size() < 2) return false;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(inbox_.data());
+        const bool fin = p[0] & 0x80;
+        const uint8_t opcode = p[0] & 0x0F;
+        const bool masked = p[1] & 0x80;
+        uint64_t length = p[1] & 0x7F;
+        size_t offset = 2;
+        if (length == 126) {
+            if (inbox_.size() < 4) return false;
+            length = (p[2] << 8) | p[3];
+            offset = 4;
+        } else if (length == 127) {
+            if (inbox_.size() < 10) return false;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+            offset = 10;
+        }
+        if (!masked || length > kMaxMessageBytes) {
+            close();
+            return false;
+        }
+        if (inbox_.size() < offset + 4 + length) return false;
+        const uint8_t* mask = p + offset;
+        std::string payload(inbox_, offset + 4, static_cast<size_t>(length));
+        for (size_t i = 0; i < payload.size(); i++) payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+        inbox_.erase(0, offset + 4 + static_cast<size_t>(length));
+
+        switch (opcode) {
+            case 0x0:
+            case 0x1:
+            case 0x2:
+                if (opcode != 0x0) binary_ = opcode == 0x2;
+                message_ += payload;
+                if (message_.size() > kMaxMessageBytes) {
+                    close();
+                    return false;
+                }
+                if (fin) {
+                    onMessage(message_, binary_);
+                    message_.clear();
+                }
+                break;
+            case 0x8:
+                close();
+                return false;
+            case 0x9:
+                frame(0xA, payload);
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+
+    void frame(uint8_t opcode, const std::string& payload) {
+        outbox_.push_back(static_cast<char>(0x80 | opcode));
+        const size_t size = payload.size();
+        if (size < 126) {
+            outbox_.push_back(static_cast<char>(size));
+        } else if (size <= UINT16_MAX) {
+            outbox_.push_back(static_cast<char>(126));
+            outbox_.push_back(static_cast<char>(size >> 8));
+            outbox_.push_back(static_cast<char>(size));
+        } else {
+            outbox_.push_back(static_cast<char>(127));
+            for (int i = 7; i >= 0; i--) outbox_.push_back(static_cast<char>(static_cast<uint64_t>(size) >> (i * 8)));
+        }
+        outbox_ += payload;
+    }
+
+    State state_ = State::Handshake;
+    std::string inbox_;
+    std::string outbox_;
+    std::string message_;
+    bool binary_ = true;
+};
+
+}  // namespace pressurepad
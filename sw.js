@@ -0,0 +1,66 @@
+// Offline cache for the page. Everything the page needs before a board is
+// connected is precached on install: the page, its manifest and images,
+// and the pinned Chart.js bundles, so at the range the page starts from
+// the cache and works without a connection. The page itself must cache or
+// the install fails; a bundle the CDN does not serve is skipped and cached
+// on its first successful load instead, so the offline start never hangs
+// on a third party.
+//
+// The page is served stale-while-revalidate: the cached copy answers at
+// once and the network copy replaces it for the next visit. The chart
+// bundles are pinned to a version, so they never change and are served
+// from the cache only. Bump CACHE_NAME when the precache list changes;
+// the old cache is dropped once the new worker takes over.
+
+const CACHE_NAME = 'pressurepad-v1';
+
+// Keep in step with chartBundles in index.html.
+const CHART_BUNDLES = [
+    'https://cdn.jsdelivr.net/npm/chart.js@4.4.4/dist/chart.umd.min.js',
+    'https://cdn.jsdelivr.net/npm/chartjs-plugin-annotation@2.2.1/dist/chartjs-plugin-annotation.min.js'
+];
+
+const PAGE = ['./', 'index.html', 'manifest.webmanifest', 'pressurepadlogo.png', 'pressurepadicon.png'];
+
+self.addEventListener('install', (event) => {
+    event.waitUntil(caches.open(CACHE_NAME)
+        .then(cache => cache.addAll(PAGE).then(() => Promise.allSettled(CHART_BUNDLES.map(url => cache.add(url)))))
+        .then(() => self.skipWaiting()));
+});
+
+self.addEventListener('activate', (event) => {
+    event.waitUntil(caches.keys()
+        .then(names => Promise.all(names.filter(name => name !== CACHE_NAME).map(name => caches.delete(name))))
+        .then(() => self.clients.claim()));
+});
+
+self.addEventListener('fetch', (event) => {
+    const { request } = event;
+    if (request.method !== 'GET') return;
+    if (CHART_BUNDLES.includes(request.url)) {
+        event.respondWith(caches.open(CACHE_NAME).then(async (cache) => {
+            const cached = await cache.match(request.url);
+            if (cached) return cached;
+            // By URL, not the page's no-cors request, so the response is
+            // not opaque and can be checked before it is kept.
+            const response = await fetch(request.url);
+            if (response.ok) cache.put(request.url, response.clone());
+            return response;
+        }));
+        return;
+    }
+    const url = new URL(request.url);
+    if (url.origin !== self.location.origin) return;
+    // ?sim, ?bench and the like are the same page.
+    const key = request.mode === 'navigate' ? new URL('./', self.location).href : request;
+    event.respondWith(caches.open(CACHE_NAME).then(async (cache) => {
+        const cached = await cache.match(key, { ignoreSearch: true });
+        const refresh = fetch(request).then((response) => {
+            if (response.ok) cache.put(key, response.clone());
+            return response;
+        });
+        if (!cached) return refresh;
+        event.waitUntil(refresh.catch(() => {}));
+        return cached;
+    }));
+});